@@ -0,0 +1,112 @@
+/*Benchmark firmware, runs the hot paths of the firmware under simavr (see
+ *simbench.c). The modules with static routines to measure are included,
+ *not linked.
+ */
+#include "common.h"
+#include <avr/sleep.h>
+#include "io.cpp"
+#include "control.cpp"
+#include "dht.cpp"
+#include "bench.h"
+
+//defined in main.cpp in the firmware
+uint8_t ref_hum = 50;
+uint8_t ref_hum_var = 3;
+enum statev state = ok;
+
+//the timer interrupt routine, called directly
+extern "C" void TIMER1_COMPA_vect(void);
+
+//number of timer interrupts to measure
+#define BENCH_TICKS 2000
+
+//results go here, so the calls aren't optimized away (two more cycles)
+static volatile int16_t sink;
+
+#define MEASURE(id, call)       \
+    do                          \
+    {                           \
+        BENCH_MARK = (id);      \
+        call;                   \
+        BENCH_MARK = BENCH_STOP;\
+    } while(0)
+
+static void nothing(void)
+{
+}
+
+static void bench_timer(void)
+/*Let the timers registered by io_init() (display multiplexing) and a few
+ *like the ones of the firmware run for BENCH_TICKS compare matches. The
+ *interrupt itself stays disabled, the routine is called when the flag is
+ *set, so only the routine is measured.
+ */
+{
+    uint16_t i;
+
+    register_timer(&nothing, TIMER_MS(10), 0);
+    register_timer(&nothing, TIMER_MS(100), 0);
+    register_timer(&nothing, TIMER_MS(300), TIMER_DEFERRED);
+    register_timer(&nothing, TIMER_MS(2000), TIMER_DEFERRED);
+    register_timer(&nothing, TIMER_MS(5000), TIMER_DEFERRED);
+    clearbit(TIMSK, OCIE1A);
+
+    for(i = 0; i < BENCH_TICKS; i++)
+    {
+        while(!testbit(TIFR, OCF1A));
+        TIFR = (1<<OCF1A);
+        MEASURE(BENCH_TIMER_ISR, TIMER1_COMPA_vect());
+        //reti enabled them
+        cli();
+    }
+}
+
+int main(void)
+{
+    uint16_t i;
+    int16_t t, h;
+
+    timer_init();
+    io_init();
+
+    MEASURE(BENCH_NOTHING, nothing());
+
+    for(i = 0; i < 4*64; i++)
+    {
+        MEASURE(BENCH_DISP_CYCLE, disp_cycle());
+    }
+    for(i = 0; i < 256; i++)
+    {
+        MEASURE(BENCH_SHIFTR_SETVAL, shiftr_setval(i));
+    }
+    for(i = 0; i < 64; i++)
+    {
+        MEASURE(BENCH_SWITCHES_RAW, sink = io_switches_raw());
+    }
+    for(i = 0; i < 256; i++)
+    {
+        MEASURE(BENCH_TEMP_CELSIUS, sink = temp_celsius(i));
+    }
+    for(i = 0; i < 64; i++)
+    {
+        MEASURE(BENCH_TEMP_MEASURE, sink = temp_measure());
+    }
+    for(i = 0; i < 64; i++)
+    {
+        //a negative temperature is the longer path
+        dht_bits[0] = 0x02;
+        dht_bits[1] = 0x1C;
+        dht_bits[2] = i & 1 ? 0x80 : 0x00;
+        dht_bits[3] = 0x65;
+        dht_new = 1;
+        MEASURE(BENCH_DHT_DECODE, dht_getdata(&t, &h));
+    }
+
+    bench_timer();
+
+    //simavr stops here
+    cli();
+    sleep_enable();
+    sleep_cpu();
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/*Shared by the benchmark firmware (bench.cpp) and the simulator running it
+ *(simbench.c). The firmware writes the id of a routine to BENCH_MARK right
+ *before calling it and BENCH_STOP right after, simbench.c counts the cycles
+ *in between.
+ */
+
+//PORTA, which the ATmega8 doesn't have, so nothing else writes there
+#define BENCH_MARK_ADDR     0x3B    //data space address
+#define BENCH_MARK          (*(volatile uint8_t*)BENCH_MARK_ADDR)
+
+#define BENCH_STOP          0
+#define BENCH_NOTHING       1   //just the markers, subtracted from the others
+#define BENCH_TIMER_ISR     2
+#define BENCH_DISP_CYCLE    3
+#define BENCH_SHIFTR_SETVAL 4
+#define BENCH_SWITCHES_RAW  5
+#define BENCH_TEMP_CELSIUS  6
+#define BENCH_TEMP_MEASURE  7
+#define BENCH_DHT_DECODE    8
+#define BENCH_COUNT         9
+
+//names used in the output and in budget
+#define BENCH_NAMES \
+    "", "nothing", "TIMER1_COMPA_vect", "disp_cycle", "shiftr_setval", \
+    "io_switches_raw", "temp_celsius", "temp_measure", "dht_getdata"
+
+#endif
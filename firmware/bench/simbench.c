@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "bench.h"
+
+/*Runs the benchmark firmware on simavr and prints the cpu cycles spent in
+ *each routine, as
+ *  cycles <routine> <calls> <average> <worst case>
+ *for tools/bench_check.py.
+ */
+
+#define BENCH_MCU   "atmega8"
+#define BENCH_F_CPU 1000000UL
+
+typedef struct BenchResult{
+    unsigned long calls;
+    avr_cycle_count_t total;
+    avr_cycle_count_t max;
+} bench_result;
+
+static const char* const names[BENCH_COUNT] = { BENCH_NAMES };
+static bench_result results[BENCH_COUNT];
+static avr_cycle_count_t start;
+static uint8_t current;
+
+static void bench_mark(struct avr_t* avr, avr_io_addr_t addr, uint8_t v,
+                       void* param)
+{
+    avr_cycle_count_t n;
+
+    if(v != BENCH_STOP)
+    {
+        current = v < BENCH_COUNT ? v : BENCH_STOP;
+        start = avr->cycle;
+        return;
+    }
+    if(current == BENCH_STOP)
+    {
+        return;
+    }
+    n = avr->cycle - start;
+    results[current].calls++;
+    results[current].total += n;
+    if(n > results[current].max)
+    {
+        results[current].max = n;
+    }
+    current = BENCH_STOP;
+}
+
+int main(int argc, char** argv)
+{
+    elf_firmware_t firmware = {{0}};
+    avr_t* avr;
+    avr_cycle_count_t overhead;
+    bench_result* r;
+    uint8_t id;
+    int state;
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s bench.elf\n", argv[0]);
+        return 1;
+    }
+    if(elf_read_firmware(argv[1], &firmware) != 0)
+    {
+        fprintf(stderr, "can't read %s\n", argv[1]);
+        return 1;
+    }
+    avr = avr_make_mcu_by_name(BENCH_MCU);
+    if(avr == NULL)
+    {
+        fprintf(stderr, "simavr doesn't know the %s\n", BENCH_MCU);
+        return 1;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = BENCH_F_CPU;
+    avr_register_io_write(avr, BENCH_MARK_ADDR, &bench_mark, NULL);
+
+    do
+    {
+        state = avr_run(avr);
+    } while(state != cpu_Done && state != cpu_Crashed);
+    if(state == cpu_Crashed)
+    {
+        fprintf(stderr, "benchmark firmware crashed\n");
+        return 1;
+    }
+
+    //the markers themselves
+    overhead = results[BENCH_NOTHING].max;
+    for(id = BENCH_NOTHING+1; id < BENCH_COUNT; id++)
+    {
+        r = &results[id];
+        if(r->calls == 0)
+        {
+            fprintf(stderr, "%s wasn't measured\n", names[id]);
+            return 1;
+        }
+        printf("cycles %s %lu %lu %lu\n", names[id], r->calls,
+               (unsigned long)(r->total/r->calls - overhead),
+               (unsigned long)(r->max - overhead));
+    }
+    return 0;
+}
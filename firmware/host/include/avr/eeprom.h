@@ -0,0 +1,13 @@
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+/*The simulated EEPROM, see sim_eeprom in host/sim.h
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_read_block(void* dst, const void* src, size_t n);
+
+#endif
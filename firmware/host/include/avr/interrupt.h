@@ -0,0 +1,27 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+void sim_sei(void);
+void sim_cli(void);
+#define sei()   sim_sei()
+#define cli()   sim_cli()
+
+/*Interrupt routines are plain functions called by sim.cpp. They are declared
+ *weak, so vectors the firmware doesn't use are simply null. Like in avr-libc
+ *they have C linkage.
+ */
+#define ISR(vector) extern "C" void vector(void)
+
+extern "C" {
+void TIMER2_COMP_vect(void) __attribute__((weak));
+void TIMER1_CAPT_vect(void) __attribute__((weak));
+void TIMER1_COMPA_vect(void) __attribute__((weak));
+void USART_RXC_vect(void) __attribute__((weak));
+void USART_UDRE_vect(void) __attribute__((weak));
+void ADC_vect(void) __attribute__((weak));
+void EE_RDY_vect(void) __attribute__((weak));
+}
+
+#endif
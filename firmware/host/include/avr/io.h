@@ -0,0 +1,229 @@
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+/*Register file of the simulated ATmega8, used instead of the avr-libc header
+ *in the host build (see host/sim.h). Registers without side effects are
+ *plain variables, the rest are routed through sim.cpp.
+ */
+
+#include <stdint.h>
+
+//I/O ports
+#define SIM_PORTB   0
+#define SIM_PORTC   1
+#define SIM_PORTD   2
+#define SIM_NPORTS  3
+
+typedef struct SimPort{
+    volatile uint8_t port;
+    volatile uint8_t ddr;
+    uint8_t in;     //level applied from outside to the pins configured as
+                    //inputs, set by the models in host/
+} sim_port;
+
+extern sim_port sim_ports[SIM_NPORTS];
+uint8_t sim_pin(uint8_t port);
+
+#define PORTB   sim_ports[SIM_PORTB].port
+#define DDRB    sim_ports[SIM_PORTB].ddr
+#define PINB    sim_pin(SIM_PORTB)
+#define PORTC   sim_ports[SIM_PORTC].port
+#define DDRC    sim_ports[SIM_PORTC].ddr
+#define PINC    sim_pin(SIM_PORTC)
+#define PORTD   sim_ports[SIM_PORTD].port
+#define DDRD    sim_ports[SIM_PORTD].ddr
+#define PIND    sim_pin(SIM_PORTD)
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define DDB0 0
+#define DDB1 1
+#define DDB2 2
+#define DDB3 3
+#define DDB4 4
+#define DDB5 5
+#define DDB6 6
+#define DDB7 7
+#define DDC0 0
+#define DDC1 1
+#define DDC2 2
+#define DDC3 3
+#define DDC4 4
+#define DDC5 5
+#define DDC6 6
+#define DDD0 0
+#define DDD1 1
+#define DDD2 2
+#define DDD3 3
+#define DDD4 4
+#define DDD5 5
+#define DDD6 6
+#define DDD7 7
+
+//status register, only the I flag is used
+extern volatile uint8_t SREG;
+#define SREG_I  7
+
+//MCU control and status
+extern volatile uint8_t MCUCR;
+#define SE      7
+#define SM2     6
+#define SM1     5
+#define SM0     4
+extern volatile uint8_t MCUCSR;
+#define WDRF    3
+#define BORF    2
+#define EXTRF   1
+#define PORF    0
+
+//timer interrupt mask and flags
+extern volatile uint8_t TIMSK;
+extern volatile uint8_t TIFR;
+#define OCIE2   7
+#define TOIE2   6
+#define TICIE1  5
+#define OCIE1A  4
+#define OCIE1B  3
+#define TOIE1   2
+#define TOIE0   0
+#define OCF2    7
+#define TOV2    6
+#define ICF1    5
+#define OCF1A   4
+#define OCF1B   3
+#define TOV1    2
+#define TOV0    0
+
+//timer0, reading the counter takes a few cycles of virtual time, so busy
+//loops polling it make progress
+extern volatile uint8_t TCCR0;
+#define CS02    2
+#define CS01    1
+#define CS00    0
+uint8_t sim_tcnt0(void);
+#define TCNT0   sim_tcnt0()
+
+//timer1
+extern volatile uint8_t TCCR1A;
+extern volatile uint8_t TCCR1B;
+extern volatile uint16_t OCR1A;
+extern volatile uint16_t ICR1;
+#define COM1A1  7
+#define COM1A0  6
+#define COM1B1  5
+#define COM1B0  4
+#define FOC1A   3
+#define FOC1B   2
+#define WGM11   1
+#define WGM10   0
+#define ICNC1   7
+#define ICES1   6
+#define WGM13   4
+#define WGM12   3
+#define CS12    2
+#define CS11    1
+#define CS10    0
+uint16_t sim_tcnt1(void);
+#define TCNT1   sim_tcnt1()
+
+//timer2, no asynchronous mode
+extern volatile uint8_t TCCR2;
+extern volatile uint8_t OCR2;
+#define FOC2    7
+#define WGM20   6
+#define COM21   5
+#define COM20   4
+#define WGM21   3
+#define CS22    2
+#define CS21    1
+#define CS20    0
+
+//ADC
+extern volatile uint8_t ADMUX;
+extern volatile uint8_t ADCSRA;
+extern volatile uint16_t ADC;
+#define REFS1   7
+#define REFS0   6
+#define ADLAR   5
+#define MUX3    3
+#define MUX2    2
+#define MUX1    1
+#define MUX0    0
+#define ADEN    7
+#define ADSC    6
+#define ADFR    5
+#define ADIF    4
+#define ADIE    3
+#define ADPS2   2
+#define ADPS1   1
+#define ADPS0   0
+
+//EEPROM, EEDR is loaded when it's read after setting EERE
+extern volatile uint8_t EECR;
+extern volatile uint16_t EEAR;
+#define EERIE   3
+#define EEMWE   2
+#define EEWE    1
+#define EERE    0
+volatile uint8_t* sim_eedr(void);
+#define EEDR    (*sim_eedr())
+#define E2END   0x1FF
+
+//USART. Outside of the RX complete routine every access to UDR counts as a
+//write of a byte to send, see sim_udr().
+volatile uint8_t* sim_udr(void);
+#define UDR     (*sim_udr())
+extern volatile uint8_t UCSRA;
+extern volatile uint8_t UCSRB;
+extern volatile uint8_t UCSRC;
+extern volatile uint8_t UBRRH;
+extern volatile uint8_t UBRRL;
+#define RXC     7
+#define TXC     6
+#define UDRE    5
+#define FE      4
+#define DOR     3
+#define PE      2
+#define U2X     1
+#define MPCM    0
+#define RXCIE   7
+#define TXCIE   6
+#define UDRIE   5
+#define RXEN    4
+#define TXEN    3
+#define UCSZ2   2
+#define RXB8    1
+#define TXB8    0
+#define URSEL   7
+#define UMSEL   6
+#define UPM1    5
+#define UPM0    4
+#define USBS    3
+#define UCSZ1   2
+#define UCSZ0   1
+#define UCPOL   0
+
+#define RAMEND  0x45F
+
+#endif
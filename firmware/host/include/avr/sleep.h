@@ -0,0 +1,21 @@
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE         0
+#define SLEEP_MODE_ADC          (1<<SM0)
+#define SLEEP_MODE_PWR_DOWN     (1<<SM1)
+#define SLEEP_MODE_PWR_SAVE     ((1<<SM1) | (1<<SM0))
+#define SLEEP_MODE_STANDBY      ((1<<SM2) | (1<<SM1))
+
+#define set_sleep_mode(mode) \
+    (MCUCR = (MCUCR & ~((1<<SM2) | (1<<SM1) | (1<<SM0))) | (mode))
+#define sleep_enable()  (MCUCR |= (1<<SE))
+#define sleep_disable() (MCUCR &= ~(1<<SE))
+
+//run virtual time until the next interrupt
+void sim_sleep(void);
+#define sleep_cpu()     sim_sleep()
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef HOST_AVR_WDT_H
+#define HOST_AVR_WDT_H
+
+#include <stdint.h>
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+
+//the simulation ends with a watchdog reset, a restart can't be simulated
+void sim_wdt_enable(uint8_t timeout) __attribute__((noreturn));
+#define wdt_enable(timeout) sim_wdt_enable(timeout)
+#define wdt_disable()
+#define wdt_reset()
+
+#endif
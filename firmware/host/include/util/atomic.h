@@ -0,0 +1,29 @@
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+/*Same construct as in avr-libc: the I flag is cleared on entry and restored
+ *by a cleanup function, which also runs on return or break.
+ */
+
+#include <avr/io.h>
+
+static inline uint8_t sim_atomic_enter(void)
+{
+    uint8_t sreg = SREG;
+
+    SREG = sreg & ~(1<<SREG_I);
+    return 1;
+}
+
+void sim_sreg_restore(const uint8_t* sreg);
+void sim_sreg_enable(const uint8_t* sreg);
+
+#define ATOMIC_RESTORESTATE \
+    uint8_t sreg_save __attribute__((__cleanup__(sim_sreg_restore))) = SREG
+#define ATOMIC_FORCEON \
+    uint8_t sreg_save __attribute__((__cleanup__(sim_sreg_enable))) = 0
+
+#define ATOMIC_BLOCK(type) \
+    for(type, sim_todo = sim_atomic_enter(); sim_todo; sim_todo = 0)
+
+#endif
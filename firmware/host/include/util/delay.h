@@ -0,0 +1,15 @@
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#error "F_CPU has to be defined before util/delay.h"
+#endif
+
+//busy waiting just advances the virtual clock
+void sim_delay(uint32_t cycles);
+#define _delay_ms(ms)   sim_delay((uint32_t)((ms)*(F_CPU/1000.0)))
+#define _delay_us(us)   sim_delay((uint32_t)((us)*(F_CPU/1000000.0)))
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_UTIL_DELAY_BASIC_H
+#define HOST_UTIL_DELAY_BASIC_H
+
+#include <stdint.h>
+
+void sim_delay(uint32_t cycles);
+//three cycles per iteration, 0 means 256 iterations
+#define _delay_loop_1(n)    sim_delay(3UL*((uint8_t)((n)-1)+1))
+#define _delay_loop_2(n)    sim_delay(4UL*((uint16_t)((n)-1)+1))
+
+#endif
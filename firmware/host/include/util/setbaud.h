@@ -0,0 +1,17 @@
+#ifndef HOST_UTIL_SETBAUD_H
+#define HOST_UTIL_SETBAUD_H
+
+/*Only what uart.cpp needs, the simulated UART ignores the baud rate settings
+ *and always runs at BAUD.
+ */
+
+#if !defined(F_CPU) || !defined(BAUD)
+#error "F_CPU and BAUD have to be defined before util/setbaud.h"
+#endif
+
+#define USE_2X          1
+#define UBRR_VALUE      (((F_CPU) + 4UL*(BAUD)) / (8UL*(BAUD)) - 1UL)
+#define UBRRL_VALUE     (UBRR_VALUE & 0xFF)
+#define UBRRH_VALUE     (UBRR_VALUE >> 8)
+
+#endif
@@ -0,0 +1,180 @@
+#include "common.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+#include "plant.h"
+#include "control.h"
+#include "io.h"
+#include "dht.h"
+
+/*Runs the firmware on the simulated ATmega8 of sim.cpp, on a board without
+ *anything connected except the pull-ups: the basin isn't full, no key is
+ *pressed, the DHT22 doesn't answer and the ADC always reads the same value.
+ *With -p, the sensors are connected to the room model of plant.cpp instead.
+ *The UART output goes to stdout, e.g. into tools/telemetry_decode.py.
+ */
+
+//trace of the room model is written this often (s)
+#define TRACE_PERIOD    60
+
+static uint16_t adc_value = 512;
+static const char* eeprom_file;
+static uint8_t with_plant;
+static FILE* trace;
+static clock_t host_start;
+
+static uint16_t board_adc(uint8_t channel)
+{
+    (void)channel;
+    return adc_value;
+}
+
+static void board_tx(uint8_t c)
+{
+    putchar(c);
+}
+
+static void board_finish(void)
+{
+    FILE* f;
+
+    fflush(stdout);
+    if(trace != NULL)
+    {
+        fclose(trace);
+    }
+    if(eeprom_file != NULL)
+    {
+        f = fopen(eeprom_file, "wb");
+        if(f == NULL || fwrite(sim_eeprom, SIM_EEPROM_SIZE, 1, f) != 1)
+        {
+            perror(eeprom_file);
+        }
+        if(f != NULL)
+        {
+            fclose(f);
+        }
+    }
+    fprintf(stderr, "sim: %.1f s simulated in %.2f s, %lu interrupts\n",
+            (double)sim_cycles/F_CPU,
+            (double)(clock() - host_start)/CLOCKS_PER_SEC,
+            (unsigned long)sim_interrupts);
+    if(with_plant)
+    {
+        plant_report(stderr);
+    }
+}
+
+static size_t read_file(const char* name, uint8_t* buf, size_t len)
+{
+    FILE* f = fopen(name, "rb");
+    size_t n;
+
+    if(f == NULL)
+    {
+        perror(name);
+        exit(1);
+    }
+    n = fread(buf, 1, len, f);
+    fclose(f);
+    return n;
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s [-t seconds] [-e eeprom.bin] [-i input] [-a adc]\n"
+            "       [-p [-r rh] [-m moisture] [-w hours] [-o trace.csv]]\n"
+            "  -t  virtual time to run, default 60 s\n"
+            "  -e  EEPROM image, loaded if it exists and saved at the end\n"
+            "  -i  file received by the UART, e.g. shell commands\n"
+            "  -a  value the ADC reads (0-1023), default 512\n"
+            "  -p  connect the room model of plant.h\n"
+            "  -r  initial relative humidity of the room, default %.0f %%\n"
+            "  -m  moisture released in the room, default %.0f g/h\n"
+            "  -w  hours until the full basin is emptied, 0: never, "
+            "default %.1f\n"
+            "  -o  write the state of the room every %d s to a csv file\n",
+            prog, plant.rh, plant.moisture, plant.empty_delay/3600,
+            TRACE_PERIOD);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    static uint8_t input[4096];
+    size_t input_len = 0;
+    double seconds = 60;
+    FILE* f;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:e:i:a:pr:m:w:o:")) != -1)
+    {
+        switch(opt)
+        {
+        case 't':
+            seconds = atof(optarg);
+            break;
+        case 'e':
+            eeprom_file = optarg;
+            break;
+        case 'i':
+            input_len = read_file(optarg, input, sizeof(input));
+            break;
+        case 'a':
+            adc_value = atoi(optarg);
+            break;
+        case 'p':
+            with_plant = 1;
+            break;
+        case 'r':
+            plant.rh = atof(optarg);
+            break;
+        case 'm':
+            plant.moisture = atof(optarg);
+            break;
+        case 'w':
+            plant.empty_delay = atof(optarg)*3600;
+            break;
+        case 'o':
+            trace = fopen(optarg, "w");
+            if(trace == NULL)
+            {
+                perror(optarg);
+                exit(1);
+            }
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    //erased EEPROM, unless there's an image from an earlier run
+    memset(sim_eeprom, 0xFF, SIM_EEPROM_SIZE);
+    if(eeprom_file != NULL && (f = fopen(eeprom_file, "rb")) != NULL)
+    {
+        fclose(f);
+        read_file(eeprom_file, sim_eeprom, SIM_EEPROM_SIZE);
+    }
+
+    //external pull-ups on all inputs, the water full switch is open
+    sim_input<PIN_FULL>(0);
+    sim_ports[SIM_PORTC].in = 0xFF;
+    sim_ports[SIM_PORTD].in = 0xFF;
+
+    sim.adc = &board_adc;
+    sim.tx = &board_tx;
+    sim.finish = &board_finish;
+    if(with_plant)
+    {
+        plant_init(trace, TRACE_PERIOD);
+    }
+    sim_init((uint64_t)(seconds*F_CPU));
+    sim_uart_rx(input, input_len);
+
+    host_start = clock();
+    firmware_main();
+    return 0;
+}
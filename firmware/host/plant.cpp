@@ -0,0 +1,314 @@
+#include "common.h"
+#include <math.h>
+#include "sim.h"
+#include "plant.h"
+#include "control.h"
+#include "dht.h"
+
+//the model is advanced this often (s)
+#define PLANT_STEP      0.1
+//heat released by condensing water, J/g
+#define LATENT_HEAT     2450.0
+//longest answer of the DHT22 (cpu cycles), a read after that is a new one
+#define DHT_ANSWER_MAX  (20*F_CPU/1000)
+
+plant_params plant = {
+    .room_volume    = 30,
+    .room_capacity  = 300e3,
+    .room_loss      = 60,
+    .base_temp      = 21,
+    .outside_ah     = 8,
+    .air_exchange   = 0.3,
+    .moisture       = 25,
+    .airflow        = 100,
+    .contact        = 0.6,
+    .coil_drop      = 18,
+    .coil_tau       = 90,
+    .cts_offset     = 6,
+    .comp_power     = 200,
+    .fan_power      = 20,
+    .basin          = 2000,
+    .empty_delay    = 3600,
+    .rh             = 70,
+};
+
+//state of the model
+static double elapsed;
+static double temp;
+static double ah;           //absolute humidity of the room air, g/m^3
+static double coil;
+static double water;        //in the basin
+static double full_since;   //-1 if the basin isn't full
+static uint8_t emptied;     //CONT is yet to be pressed
+static uint8_t outputs;     //OUT_* bits at the last step
+
+//statistics
+static double err_sq;       //integral of the squared distance of the
+                            //humidity to the band the controller keeps it in
+static double rh_sum;
+static double rh_max;
+static double comp_time;
+static double fan_time;
+static double removed;
+static double full_time;
+static double full_run;     //fan or compressor on while the basin is full
+static uint32_t comp_starts;
+static uint32_t fulls;
+
+static FILE* trace;
+static double trace_period;
+static double trace_next;
+
+static double sat_ah(double t)
+/*Absolute humidity of saturated air at $t degrees (Magnus formula)
+ */
+{
+    return 6.112*exp(17.67*t/(t+243.5)) * 100 * 2.1674/(273.15+t);
+}
+
+static double room_rh(void)
+{
+    double rh = 100*ah/sat_ah(temp);
+
+    return rh > 99.9 ? 99.9 : rh;
+}
+
+static void plant_step(void)
+{
+    const double dt = PLANT_STEP;
+    uint8_t out = control_outputs();
+    uint8_t fan = out & OUT_FAN;
+    uint8_t comp = out & OUT_COMP;
+    double target = temp;
+    double cond = 0;
+    double heat;
+    double rh, err;
+
+    //coil, it gets colder without the fan blowing room air over it
+    if(comp)
+    {
+        target = temp - (fan ? plant.coil_drop : 1.5*plant.coil_drop);
+    }
+    coil += (target - coil) * dt / (fan ? plant.coil_tau : 3*plant.coil_tau);
+
+    //condensation (g/s) from the part of the air that reaches the coil
+    if(fan && ah > sat_ah(coil))
+    {
+        cond = plant.airflow/3600 * plant.contact * (ah - sat_ah(coil));
+    }
+
+    //the compressor only moves heat around within the room, everything it
+    //and the fan consume ends up in it, as well as the latent heat
+    heat = (comp ? plant.comp_power : 0) + (fan ? plant.fan_power : 0)
+           + cond*LATENT_HEAT + plant.room_loss*(plant.base_temp - temp);
+    temp += heat * dt / plant.room_capacity;
+    ah += (plant.moisture/3600 - cond) * dt / plant.room_volume
+          + plant.air_exchange/3600 * (plant.outside_ah - ah) * dt;
+
+    //basin, someone empties it a while after it's full, and presses CONT
+    //once the controller noticed
+    water += cond*dt;
+    removed += cond*dt;
+    if(full_since < 0 && water >= plant.basin)
+    {
+        full_since = elapsed;
+        fulls++;
+    }
+    if(full_since >= 0)
+    {
+        full_time += dt;
+        //$out is from before the switch tripped in the first step
+        if((fan || comp) && elapsed > full_since)
+        {
+            full_run += dt;
+        }
+        if(plant.empty_delay > 0 &&
+           elapsed - full_since >= plant.empty_delay)
+        {
+            water = 0;
+            full_since = -1;
+            emptied = 1;
+        }
+    }
+    if(emptied && !water_full())
+    {
+        emptied = 0;
+        if(state == waterfull)
+        {
+            state = ok;
+        }
+    }
+    sim_input<PIN_FULL>(full_since >= 0);
+
+    rh = room_rh();
+    err = rh > ref_hum ? rh - ref_hum
+        : rh < ref_hum - ref_hum_var ? ref_hum - ref_hum_var - rh : 0;
+    err_sq += err*err*dt;
+    rh_sum += rh*dt;
+    rh_max = rh > rh_max ? rh : rh_max;
+    if(comp)
+    {
+        comp_time += dt;
+        if(!(outputs & OUT_COMP))
+        {
+            comp_starts++;
+        }
+    }
+    if(fan)
+    {
+        fan_time += dt;
+    }
+    outputs = out;
+    elapsed += dt;
+
+    if(trace && elapsed >= trace_next)
+    {
+        trace_next += trace_period;
+        fprintf(trace, "%.1f,%.1f,%.2f,%.2f,%d,%d,%.0f,%d\n", elapsed, rh,
+                temp, coil, fan != 0, comp != 0, water, state);
+    }
+}
+
+static uint8_t dht_level(uint32_t us, const uint8_t* bits)
+/*Level of the data line $us microseconds after the controller released it:
+ *the sensor pulls it low for 80 us, releases it for 80 us, then sends 40
+ *bits as a 50 us low followed by a high of 26 us (0) or 70 us (1).
+ */
+{
+    uint8_t i;
+    uint32_t high;
+
+    if(us < 30)
+    {
+        return 1;
+    }
+    us -= 30;
+    if(us < 80)
+    {
+        return 0;
+    }
+    us -= 80;
+    if(us < 80)
+    {
+        return 1;
+    }
+    us -= 80;
+    for(i = 0; i < 40; i++)
+    {
+        if(us < 50)
+        {
+            return 0;
+        }
+        us -= 50;
+        high = (bits[i/8] >> (7 - i%8)) & 1 ? 70 : 26;
+        if(us < high)
+        {
+            return 1;
+        }
+        us -= high;
+    }
+    return us >= 50;
+}
+
+static void plant_pin(uint8_t port)
+/*The DHT22 starts answering when the controller releases the data line,
+ *i.e. at the first read with the pin configured as input.
+ */
+{
+    static uint8_t answering;
+    static uint64_t start;
+    static uint8_t bits[5];
+    uint16_t h, t;
+
+    if(port != sim_pin_port<PIN_DHT>())
+    {
+        return;
+    }
+    if(PIN_DHT::is_output())
+    {
+        answering = 0;
+        return;
+    }
+    if(!answering || sim_cycles - start > DHT_ANSWER_MAX)
+    {
+        answering = 1;
+        start = sim_cycles;
+        //sent as tenths, temperature as sign and magnitude
+        h = (uint16_t)(room_rh()*10 + 0.5);
+        t = (uint16_t)(fabs(temp)*10 + 0.5) | (temp < 0 ? 0x8000 : 0);
+        bits[0] = h >> 8;
+        bits[1] = h;
+        bits[2] = t >> 8;
+        bits[3] = t;
+        bits[4] = bits[0] + bits[1] + bits[2] + bits[3];
+    }
+    sim_input<PIN_DHT>(dht_level((sim_cycles - start) * 1000000 / F_CPU,
+                                 bits));
+}
+
+static uint16_t plant_adc(uint8_t channel)
+/*The thermistor reading that temp_measure() turns into the coil
+ *temperature (plus cts_offset), by solving the calibration polynomial for
+ *the ADC value
+ */
+{
+    double d, x;
+
+    if(channel != PIN_CTS::channel)
+    {
+        return 0;
+    }
+    d = TEMP_CAL_B*TEMP_CAL_B - 4*TEMP_CAL_A*(TEMP_CAL_C - coil - plant.cts_offset);
+    x = d > 0 ? (sqrt(d) - TEMP_CAL_B) / (2*TEMP_CAL_A) : 0;
+    //the curve is over the upper 8 of the 10 bits
+    x = 4*x + 0.5;
+    return x < 0 ? 0 : x > 1023 ? 1023 : (uint16_t)x;
+}
+
+void plant_init(FILE* f, double period)
+/*Connect the model to the controller, starting in equilibrium with the
+ *rest of the building and the given humidity. A line is written to $f
+ *every $period seconds if it's given.
+ */
+{
+    temp = plant.base_temp;
+    coil = temp;
+    ah = plant.rh/100 * sat_ah(temp);
+    full_since = -1;
+    trace = f;
+    trace_period = period;
+    trace_next = period;
+    if(trace)
+    {
+        fprintf(trace, "time_s,rh,temp,coil_temp,fan,comp,water_g,state\n");
+    }
+
+    sim.pin = &plant_pin;
+    sim.adc = &plant_adc;
+    sim.step = &plant_step;
+    sim.step_cycles = PLANT_STEP*F_CPU;
+}
+
+void plant_report(FILE* f)
+{
+    double hours = elapsed/3600;
+
+    if(elapsed <= 0)
+    {
+        return;
+    }
+    fprintf(f, "plant: %.1f h\n", hours);
+    fprintf(f, "  humidity      mean %.1f %%, max %.1f %%, now %.1f %%\n",
+            rh_sum/elapsed, rh_max, room_rh());
+    fprintf(f, "  tracking      rms error %.2f %% outside %d-%d %%\n",
+            sqrt(err_sq/elapsed), ref_hum - ref_hum_var, ref_hum);
+    fprintf(f, "  compressor    duty %.1f %%, %lu starts (%.2f per hour)\n",
+            100*comp_time/elapsed, (unsigned long)comp_starts,
+            comp_starts/hours);
+    fprintf(f, "  fan           duty %.1f %%\n", 100*fan_time/elapsed);
+    fprintf(f, "  water         %.0f g removed (%.0f g/day), basin full %lu "
+            "times for %.1f h\n", removed, removed/hours*24,
+            (unsigned long)fulls, full_time/3600);
+    fprintf(f, "                outputs on for %.1f s while full\n", full_run);
+    fprintf(f, "  temperature   room %.1f, coil %.1f\n", temp, coil);
+}
@@ -0,0 +1,47 @@
+#ifndef PLANT_H
+#define PLANT_H
+
+/*Thermodynamic model of a room with the dehumidifier in it, connected to
+ *the simulated controller of sim.cpp:
+ *  room        air temperature and absolute humidity, heat exchange with
+ *              the rest of the building, moisture from a source and from
+ *              outside air leaking in
+ *  coil        first order response to the compressor and the fan
+ *  condensate  air blown over the coil below its dew point, collected in
+ *              the basin, which trips the water full switch when it's full
+ *  sensors     DHT22 answering on its data line, thermistor voltage from the
+ *              calibration curve in control.h
+ *All times in seconds, temperatures in degrees celsius, water in grams.
+ */
+
+#include <stdio.h>
+
+typedef struct PlantParams{
+    double room_volume;     //m^3
+    double room_capacity;   //J/K, air, walls and furniture
+    double room_loss;       //W/K to the rest of the building
+    double base_temp;       //temperature of the rest of the building
+    double outside_ah;      //absolute humidity of outside air, g/m^3
+    double air_exchange;    //room volumes per hour
+    double moisture;        //g/h released in the room
+    double airflow;         //m^3/h through the coil while the fan runs
+    double contact;         //fraction of the air reaching coil temperature
+    double coil_drop;       //coil below room temperature with compressor
+                            //and fan running, more without the fan
+    double coil_tau;        //time constant of the coil with the fan running
+    double cts_offset;      //the thermistor reads this much above the coil
+                            //temperature (TEMP_CAL_C is off by 6 degrees)
+    double comp_power;      //W, ends up in the room
+    double fan_power;       //W
+    double basin;           //capacity
+    double empty_delay;     //until someone empties the full basin (and
+                            //presses CONT), 0: never
+    double rh;              //initial relative humidity, %
+} plant_params;
+
+extern plant_params plant;
+
+void plant_init(FILE* trace, double trace_period);
+void plant_report(FILE* f);
+
+#endif
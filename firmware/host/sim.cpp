@@ -0,0 +1,510 @@
+#include "common.h"
+#include <stdio.h>
+#include <avr/eeprom.h>
+#include "uart.h"
+#include "sim.h"
+
+/*The peripherals only look at their registers when sim_update() is called,
+ *i.e. whenever virtual time passes and after every interrupt routine. That's
+ *enough, as the firmware doesn't spend any virtual time in between anyway.
+ */
+
+sim_port sim_ports[SIM_NPORTS];
+volatile uint8_t SREG;
+volatile uint8_t MCUCR;
+volatile uint8_t MCUCSR = (1<<PORF);
+volatile uint8_t TIMSK;
+volatile uint8_t TIFR;
+volatile uint8_t TCCR0;
+volatile uint8_t TCCR1A;
+volatile uint8_t TCCR1B;
+volatile uint16_t OCR1A;
+volatile uint16_t ICR1;
+volatile uint8_t TCCR2;
+volatile uint8_t OCR2;
+volatile uint8_t ADMUX;
+volatile uint8_t ADCSRA;
+volatile uint16_t ADC;
+volatile uint8_t EECR;
+volatile uint16_t EEAR;
+volatile uint8_t UCSRA = (1<<UDRE);
+volatile uint8_t UCSRB;
+volatile uint8_t UCSRC = (1<<URSEL) | (1<<UCSZ1) | (1<<UCSZ0);
+volatile uint8_t UBRRH;
+volatile uint8_t UBRRL;
+static volatile uint8_t eedr;
+
+sim_hooks sim;
+uint64_t sim_cycles;
+uint8_t sim_eeprom[SIM_EEPROM_SIZE];
+uint32_t sim_interrupts;
+
+#define SIM_NEVER       UINT64_MAX
+//a byte on the line: start bit, 8 data bits, stop bit
+#define UART_CYCLES     (10*F_CPU/BAUD)
+#define EEPROM_CYCLES   ((uint64_t)SIM_EEPROM_US*F_CPU/1000000UL)
+
+//timer clock select bits to prescaler, 0: stopped (or external clock)
+static const uint16_t timer_prescaler[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+static const uint16_t timer2_prescaler[8] = {0, 1, 8, 32, 64, 128, 256, 1024};
+//ADPS bits to prescaler
+static const uint8_t adc_prescaler[8] = {2, 2, 4, 8, 16, 32, 64, 128};
+
+typedef struct SimCounter{
+    uint16_t count;
+    uint16_t frac;      //cpu cycles since the last count
+} sim_counter;
+
+static sim_counter t0;
+static sim_counter t1;
+static sim_counter t2;
+
+static uint64_t sim_end = SIM_NEVER;
+static uint64_t step_next = SIM_NEVER;
+//completion of what the peripherals are doing, SIM_NEVER if idle
+static uint64_t adc_done = SIM_NEVER;
+static uint64_t ee_done = SIM_NEVER;
+static uint64_t tx_done = SIM_NEVER;
+static uint64_t rx_done = SIM_NEVER;
+
+static uint16_t ee_addr;
+static uint8_t ee_data;
+static uint8_t tx_shift;                //byte being sent
+static const uint8_t* rx_data;          //bytes still to be received
+static size_t rx_len;
+static uint8_t rx_byte;                 //received byte, read from UDR
+static uint8_t rx_reading;              //in the RX complete routine
+static uint8_t udr;                     //written to UDR, to be sent
+static uint8_t udr_full;                //udr wasn't taken yet
+
+static void count(sim_counter* c, uint16_t p, uint32_t top, uint64_t cycles)
+/*Advance counter $c by $cycles at prescaler $p (0: stopped), counting from 0
+ *to $top-1
+ */
+{
+    uint64_t n;
+
+    if(p == 0)
+    {
+        return;
+    }
+    n = c->frac + cycles;
+    c->count = (c->count + n / p) % top;
+    c->frac = n % p;
+}
+
+static uint16_t t2_top(void)
+/*Number of timer2 counts per round, up to OCR2 in CTC mode
+ */
+{
+    if((TCCR2 & ((1<<WGM21) | (1<<WGM20))) == (1<<WGM21))
+    {
+        return (uint16_t)OCR2 + 1;
+    }
+    return 0x100;
+}
+
+static uint64_t t1_match(void)
+/*Virtual time of the next compare match A
+ */
+{
+    uint16_t p = timer_prescaler[TCCR1B & 0x07];
+    uint32_t steps = (uint16_t)(OCR1A - t1.count);
+
+    if(p == 0)
+    {
+        return SIM_NEVER;
+    }
+    if(steps == 0)
+    {
+        //the match for this count is over, wait for the next round
+        steps = 0x10000;
+    }
+    return sim_cycles + (uint64_t)steps*p - t1.frac;
+}
+
+static uint64_t t2_match(void)
+/*Virtual time of the next timer2 compare match
+ */
+{
+    uint16_t p = timer2_prescaler[TCCR2 & 0x07];
+    uint16_t top = t2_top();
+    uint32_t steps = (OCR2 + top - t2.count) % top;
+
+    if(p == 0)
+    {
+        return SIM_NEVER;
+    }
+    if(steps == 0)
+    {
+        steps = top;
+    }
+    return sim_cycles + (uint64_t)steps*p - t2.frac;
+}
+
+static void sim_update(void)
+/*Start what the firmware asked the peripherals to do since the last call
+ */
+{
+    if((ADCSRA & (1<<ADEN)) && (ADCSRA & (1<<ADSC)) && adc_done == SIM_NEVER)
+    {
+        adc_done = sim_cycles + 13UL*adc_prescaler[ADCSRA & 0x07];
+    }
+    if((EECR & (1<<EEWE)) && ee_done == SIM_NEVER)
+    {
+        ee_addr = EEAR & E2END;
+        ee_data = eedr;
+        ee_done = sim_cycles + EEPROM_CYCLES;
+    }
+    if(udr_full && tx_done == SIM_NEVER)
+    {
+        //data register to shift register
+        tx_shift = udr;
+        udr_full = 0;
+        tx_done = sim_cycles + UART_CYCLES;
+    }
+    if(!udr_full)
+    {
+        UCSRA |= (1<<UDRE);
+    }
+    else
+    {
+        UCSRA &= ~(1<<UDRE);
+    }
+    if(rx_len != 0 && (UCSRB & (1<<RXEN)) && rx_done == SIM_NEVER)
+    {
+        rx_done = sim_cycles + UART_CYCLES;
+    }
+}
+
+static void sim_events(void)
+/*Finish what the peripherals were doing, if it's due now
+ */
+{
+    if(adc_done == sim_cycles)
+    {
+        adc_done = SIM_NEVER;
+        ADC = sim.adc ? sim.adc(ADMUX & 0x0F) & 0x3FF : 0;
+        ADCSRA = (ADCSRA & ~(1<<ADSC)) | (1<<ADIF);
+    }
+    if(ee_done == sim_cycles)
+    {
+        ee_done = SIM_NEVER;
+        sim_eeprom[ee_addr] = ee_data;
+        EECR &= ~(1<<EEWE);
+    }
+    if(tx_done == sim_cycles)
+    {
+        tx_done = SIM_NEVER;
+        if(sim.tx && (UCSRB & (1<<TXEN)))
+        {
+            sim.tx(tx_shift);
+        }
+    }
+    if(rx_done == sim_cycles)
+    {
+        rx_done = SIM_NEVER;
+        if(UCSRA & (1<<RXC))
+        {
+            //the previous byte wasn't read in time
+            UCSRA |= (1<<DOR);
+        }
+        rx_byte = *rx_data++;
+        rx_len--;
+        UCSRA |= (1<<RXC);
+    }
+    if(step_next == sim_cycles)
+    {
+        step_next += sim.step_cycles;
+        sim.step();
+    }
+}
+
+static uint8_t sim_irq(void)
+/*Call the routines of all pending interrupts, as long as interrupts are
+ *enabled. Same priorities as the vector table. Returns the number of
+ *routines called.
+ */
+{
+    void (*vect)(void);
+    uint8_t rx;
+    uint8_t n = 0;
+
+    while(SREG & (1<<SREG_I))
+    {
+        sim_update();
+        rx = 0;
+        if((TIFR & (1<<OCF2)) && (TIMSK & (1<<OCIE2)))
+        {
+            TIFR &= ~(1<<OCF2);
+            vect = TIMER2_COMP_vect;
+        }
+        else if((TIFR & (1<<ICF1)) && (TIMSK & (1<<TICIE1)))
+        {
+            TIFR &= ~(1<<ICF1);
+            vect = TIMER1_CAPT_vect;
+        }
+        else if((TIFR & (1<<OCF1A)) && (TIMSK & (1<<OCIE1A)))
+        {
+            TIFR &= ~(1<<OCF1A);
+            vect = TIMER1_COMPA_vect;
+        }
+        else if((UCSRA & (1<<RXC)) && (UCSRB & (1<<RXCIE)))
+        {
+            UCSRA &= ~((1<<RXC) | (1<<DOR));
+            rx = 1;
+            vect = USART_RXC_vect;
+        }
+        else if((UCSRB & (1<<UDRIE)) && !udr_full)
+        {
+            vect = USART_UDRE_vect;
+        }
+        else if((ADCSRA & (1<<ADIF)) && (ADCSRA & (1<<ADIE)))
+        {
+            ADCSRA &= ~(1<<ADIF);
+            vect = ADC_vect;
+        }
+        else if((EECR & (1<<EERIE)) && !(EECR & (1<<EEWE)))
+        {
+            vect = EE_RDY_vect;
+        }
+        else
+        {
+            break;
+        }
+
+        if(vect == NULL)
+        {
+            fprintf(stderr, "sim: interrupt enabled without a routine\n");
+            exit(2);
+        }
+        //UDR reads the receive buffer in the meantime
+        rx_reading = rx;
+        SREG &= ~(1<<SREG_I);
+        vect();
+        SREG |= (1<<SREG_I);
+        rx_reading = 0;
+        sim_interrupts++;
+        n++;
+    }
+    sim_update();
+    return n;
+}
+
+static void sim_run(uint64_t until, uint8_t wake)
+/*Advance the virtual clock to $until, calling the interrupt routines which
+ *become due on the way. With $wake, return after the first one instead.
+ */
+{
+    uint64_t next;
+    uint64_t t1_at;
+    uint64_t t2_at;
+    uint64_t d;
+
+    while(1)
+    {
+        if(sim_irq() != 0 && wake)
+        {
+            return;
+        }
+        if(sim_cycles >= until)
+        {
+            return;
+        }
+        if(sim_cycles >= sim_end)
+        {
+            sim_finish();
+        }
+
+        t1_at = t1_match();
+        t2_at = t2_match();
+        next = until;
+        next = sim_end < next ? sim_end : next;
+        next = t1_at < next ? t1_at : next;
+        next = t2_at < next ? t2_at : next;
+        next = adc_done < next ? adc_done : next;
+        next = ee_done < next ? ee_done : next;
+        next = tx_done < next ? tx_done : next;
+        next = rx_done < next ? rx_done : next;
+        next = step_next < next ? step_next : next;
+
+        d = next - sim_cycles;
+        count(&t0, timer_prescaler[TCCR0 & 0x07], 0x100, d);
+        count(&t1, timer_prescaler[TCCR1B & 0x07], 0x10000, d);
+        count(&t2, timer2_prescaler[TCCR2 & 0x07], t2_top(), d);
+        sim_cycles = next;
+        if(t1_at == sim_cycles)
+        {
+            TIFR |= (1<<OCF1A);
+        }
+        if(t2_at == sim_cycles)
+        {
+            TIFR |= (1<<OCF2);
+        }
+        sim_events();
+    }
+}
+
+void sim_init(uint64_t end)
+/*Set up the simulation, to end at virtual time $end. Set the hooks before.
+ */
+{
+    sim_end = end;
+    if(sim.step && sim.step_cycles != 0)
+    {
+        step_next = sim_cycles + sim.step_cycles;
+    }
+}
+
+void sim_uart_rx(const uint8_t* data, size_t len)
+/*Receive $len bytes from $data, one after the other at the baud rate.
+ *$data has to stay valid until they're received.
+ */
+{
+    rx_data = data;
+    rx_len = len;
+}
+
+void sim_finish(void)
+{
+    if(sim.finish)
+    {
+        sim.finish();
+    }
+    exit(0);
+}
+
+//interface of the replacements for avr-libc in host/include
+
+void sim_delay(uint32_t cycles)
+{
+    sim_run(sim_cycles + cycles, 0);
+}
+
+void sim_sleep(void)
+{
+    sim_run(SIM_NEVER, 1);
+}
+
+void sim_sei(void)
+/*Like on the AVR, the instruction after sei is executed before any pending
+ *interrupt, here that's up to the next call into sim.cpp (e.g. sleep_cpu()).
+ */
+{
+    SREG |= (1<<SREG_I);
+}
+
+void sim_cli(void)
+{
+    SREG &= ~(1<<SREG_I);
+}
+
+void sim_sreg_restore(const uint8_t* sreg)
+{
+    SREG = *sreg;
+    sim_irq();
+}
+
+void sim_sreg_enable(const uint8_t* sreg)
+{
+    (void)sreg;
+    SREG |= (1<<SREG_I);
+    sim_irq();
+}
+
+void sim_set_input(uint8_t port, uint8_t mask, uint8_t level)
+{
+    uint8_t old = sim_ports[port].in;
+
+    if(level)
+    {
+        sim_ports[port].in |= mask;
+    }
+    else
+    {
+        sim_ports[port].in &= ~mask;
+    }
+
+    //the edge selected by ICES1 on ICP1 (PB0) captures the timer1 count,
+    //the noise canceler delay is left out
+    if(port == SIM_PORTB && ((old ^ sim_ports[port].in) & (1<<PB0)) &&
+       testbit(sim_ports[port].in, PB0) == testbit(TCCR1B, ICES1))
+    {
+        ICR1 = t1.count;
+        TIFR |= (1<<ICF1);
+    }
+}
+
+uint8_t sim_pin(uint8_t port)
+{
+    sim_port* p = &sim_ports[port];
+
+    if(sim.pin)
+    {
+        sim.pin(port);
+    }
+    return (p->port & p->ddr) | (p->in & ~p->ddr);
+}
+
+uint8_t sim_tcnt0(void)
+{
+    sim_delay(SIM_POLL_CYCLES);
+    return t0.count;
+}
+
+uint16_t sim_tcnt1(void)
+{
+    return t1.count;
+}
+
+volatile uint8_t* sim_udr(void)
+/*UDR is only read in the RX complete routine, anything else writes a byte
+ *to send. A flag marks it as written, so every value can be sent.
+ */
+{
+    if(rx_reading)
+    {
+        return &rx_byte;
+    }
+    udr_full = 1;
+    return &udr;
+}
+
+volatile uint8_t* sim_eedr(void)
+{
+    if(EECR & (1<<EERE))
+    {
+        EECR &= ~(1<<EERE);
+        eedr = sim_eeprom[EEAR & E2END];
+    }
+    return &eedr;
+}
+
+void sim_wdt_enable(uint8_t timeout)
+{
+    (void)timeout;
+    fprintf(stderr, "sim: watchdog reset after %.3f s\n",
+            (double)sim_cycles/F_CPU);
+    sim_finish();
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr)
+{
+    //like avr-libc, wait for a write in progress
+    while(EECR & (1<<EEWE))
+    {
+        sim_delay(SIM_POLL_CYCLES);
+    }
+    return sim_eeprom[(size_t)addr & E2END];
+}
+
+void eeprom_read_block(void* dst, const void* src, size_t n)
+{
+    uint8_t* d = (uint8_t*)dst;
+
+    while(n--)
+    {
+        *d++ = eeprom_read_byte((const uint8_t*)src);
+        src = (const uint8_t*)src + 1;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef SIM_H
+#define SIM_H
+
+/*Host build of the firmware. The sources in src/ are compiled unchanged for
+ *the host, against the headers in host/include instead of avr-libc. These
+ *turn the registers into variables and the busy waits into calls to sim.cpp,
+ *which models the peripherals of the ATmega8 on a virtual clock counting cpu
+ *cycles:
+ *  ports       pins read back what the models in host/ apply to the inputs
+ *  timer0      counter only
+ *  timer1      counter, compare match A, input capture on PB0
+ *  timer2      counter and compare match, normal and CTC mode
+ *  ADC         single conversions, values from sim.adc
+ *  EEPROM      sim_eeprom, writes take 8.5 ms
+ *  USART       bytes take 10 bit times, sent ones go to sim.tx
+ *Time only passes while the firmware sleeps, waits or polls a counter, code
+ *itself runs in zero time. So the results don't depend on the speed of the
+ *host, and a simulation runs as fast as the host can execute the firmware.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include "pins.h"
+
+#define SIM_EEPROM_SIZE     (E2END+1)
+//virtual time it takes to read a timer counter in a polling loop
+#define SIM_POLL_CYCLES     6
+//an EEPROM write takes 8.5 ms, no matter the cpu clock
+#define SIM_EEPROM_US       8500
+
+typedef struct SimHooks{
+    //before the pins of $port (SIM_PORTx) are read, may update
+    //sim_ports[port].in
+    void (*pin)(uint8_t port);
+    //result of a conversion of ADC input $channel, 0-1023
+    uint16_t (*adc)(uint8_t channel);
+    //byte sent by the USART
+    void (*tx)(uint8_t c);
+    //called every step_cycles of virtual time, e.g. to advance models
+    void (*step)(void);
+    uint32_t step_cycles;
+    //end of the simulation, right before the program exits
+    void (*finish)(void);
+} sim_hooks;
+
+
+extern sim_hooks sim;
+extern uint64_t sim_cycles;             //virtual time in cpu cycles
+extern uint8_t sim_eeprom[SIM_EEPROM_SIZE];
+extern uint32_t sim_interrupts;         //interrupt routines called so far
+
+void sim_init(uint64_t end);
+void sim_uart_rx(const uint8_t* data, size_t len);
+void sim_set_input(uint8_t port, uint8_t mask, uint8_t level);
+void sim_finish(void) __attribute__((noreturn));
+
+//index in sim_ports of a pin of pins.h
+template<class pin> constexpr uint8_t sim_pin_port(void)
+{
+    return(pin::port == port_b ? SIM_PORTB :
+           pin::port == port_c ? SIM_PORTC : SIM_PORTD);
+}
+//apply $level (0 or 1) to the input of a pin of pins.h
+template<class pin> inline void sim_input(uint8_t level)
+{
+    sim_set_input(sim_pin_port<pin>(), pin::bit, level);
+}
+
+//main() of the firmware, renamed by the Makefile
+int firmware_main(void);
+
+#endif
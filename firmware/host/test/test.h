@@ -0,0 +1,30 @@
+#ifndef TEST_H
+#define TEST_H
+
+/*Unit tests of the modules in src/, run by 'make test' on the simulated
+ *controller of sim.cpp. test_<module>.cpp includes src/<module>.cpp, so it gets at
+ *the static parts as well, and is linked with the objects of all the other
+ *modules. Every test is a program of its own, it exits with 1 if a check
+ *failed.
+ */
+
+#include <stdio.h>
+
+static int test_failed;
+
+//report $cond if it doesn't hold, and carry on with the next check
+#define CHECK(cond) \
+    do \
+    { \
+        if(!(cond)) \
+        { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+                    __LINE__, #cond); \
+            test_failed++; \
+        } \
+    } while(0)
+
+//return value of main()
+#define TEST_RESULT()   (test_failed != 0)
+
+#endif
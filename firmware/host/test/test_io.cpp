@@ -0,0 +1,208 @@
+#include "io.cpp"
+#include <string.h>
+#include <util/delay.h>
+#include "sim.h"
+#include "test.h"
+
+/*Key engine of the IO panel: debouncing, press, release, long and repeat
+ *events, and the event queue. The keys are read through the shift register,
+ *io_switches_raw() reads PIN_IOKEY once per key, SW1 to SW4, all in the same
+ *instant of virtual time. The panel model counts the reads of an instant to
+ *know which key is selected.
+ */
+
+#define MAX_EVENTS      64
+
+static uint8_t keys;            //SW_* bits pressed on the panel
+
+typedef struct Event{
+    uint8_t ev;
+    double ms;                  //virtual time it was taken from the queue
+} event;
+
+static event events_got[MAX_EVENTS];
+static uint8_t n_events;
+
+static void panel_pin(uint8_t port)
+{
+    static uint64_t instant = UINT64_MAX;
+    static uint8_t sel;
+
+    if(port != sim_pin_port<PIN_IOKEY>())
+    {
+        return;
+    }
+    sel = sim_cycles == instant ? sel + 1 : 0;
+    instant = sim_cycles;
+    //a pressed key pulls the line low while it's selected
+    sim_input<PIN_IOKEY>(!(sel < 4 && (keys >> sel) & 1));
+}
+
+static double now_ms(void)
+{
+    return (double)sim_cycles*1000/F_CPU;
+}
+
+static void run(double ms, uint8_t read)
+/*Let $ms pass, taking the events from the queue every millisecond if $read
+ */
+{
+    uint8_t ev;
+    double end = now_ms() + ms;
+
+    while(now_ms() < end)
+    {
+        _delay_ms(1);
+        while(read && (ev = io_key_get()) != 0 && n_events < MAX_EVENTS)
+        {
+            events_got[n_events].ev = ev;
+            events_got[n_events].ms = now_ms();
+            n_events++;
+        }
+    }
+}
+
+static void reset(void)
+/*All keys up for long enough, and nothing recorded
+ */
+{
+    keys = 0;
+    run(200, 1);
+    n_events = 0;
+}
+
+static void test_press_release(void)
+{
+    double t;
+
+    reset();
+    t = now_ms();
+    keys = SW_UP;
+    run(300, 1);
+    keys = 0;
+    run(100, 1);
+    CHECK(n_events == 2);
+    CHECK(events_got[0].ev == (KEY_PRESS | SW_UP));
+    //debounced for KEY_INTEGRATE scans of 4 ticks, the first one comes
+    //anywhere in between scans
+    CHECK(events_got[0].ms - t >= 12 && events_got[0].ms - t <= 21);
+    CHECK(events_got[1].ev == (KEY_RELEASE | SW_UP));
+    CHECK(events_got[1].ms - t - 300 >= 12 && events_got[1].ms - t - 300 <= 21);
+}
+
+static void test_bounce(void)
+/*Contacts bouncing on press and release give one event each, a short
+ *spike none
+ */
+{
+    uint8_t i;
+
+    reset();
+    for(i = 0; i < 10; i++)
+    {
+        keys = i & 1 ? SW_DOWN : 0;
+        run(1, 1);
+    }
+    keys = SW_DOWN;
+    run(200, 1);
+    for(i = 0; i < 10; i++)
+    {
+        keys = i & 1 ? 0 : SW_DOWN;
+        run(1, 1);
+    }
+    keys = 0;
+    run(100, 1);
+    CHECK(n_events == 2);
+    CHECK(events_got[0].ev == (KEY_PRESS | SW_DOWN));
+    CHECK(events_got[1].ev == (KEY_RELEASE | SW_DOWN));
+
+    reset();
+    keys = SW_CONT;
+    run(8, 1);
+    keys = 0;
+    run(100, 1);
+    CHECK(n_events == 0);
+}
+
+static void test_long_repeat(void)
+{
+    uint8_t i;
+
+    reset();
+    keys = SW_UP;
+    run(1500, 1);
+    keys = 0;
+    run(100, 1);
+    //press, long 800 ms after the press, repeats every 150 ms (whole scans
+    //of 4 ticks, so a bit less), four of them before the release
+    CHECK(n_events == 7);
+    CHECK(events_got[0].ev == (KEY_PRESS | SW_UP));
+    CHECK(events_got[1].ev == (KEY_LONG | SW_UP));
+    CHECK(events_got[1].ms - events_got[0].ms >= 790 &&
+          events_got[1].ms - events_got[0].ms <= 810);
+    for(i = 2; i < n_events - 1; i++)
+    {
+        CHECK(events_got[i].ev == (KEY_REPEAT | SW_UP));
+        CHECK(events_got[i].ms - events_got[i-1].ms >= 140 &&
+              events_got[i].ms - events_got[i-1].ms <= 160);
+    }
+    CHECK(events_got[n_events-1].ev == (KEY_RELEASE | SW_UP));
+}
+
+static void test_two_keys(void)
+{
+    reset();
+    keys = SW_UP;
+    run(100, 1);
+    keys = SW_UP | SW_ONOFF;
+    run(100, 1);
+    keys = SW_ONOFF;
+    run(100, 1);
+    keys = 0;
+    run(100, 1);
+    CHECK(n_events == 4);
+    CHECK(events_got[0].ev == (KEY_PRESS | SW_UP));
+    CHECK(events_got[1].ev == (KEY_PRESS | SW_ONOFF));
+    CHECK(events_got[2].ev == (KEY_RELEASE | SW_UP));
+    CHECK(events_got[3].ev == (KEY_RELEASE | SW_ONOFF));
+}
+
+static void test_overflow(void)
+/*Nobody takes the events: the queue keeps the oldest ones, the rest is
+ *dropped. Once there's room again, new events get through.
+ */
+{
+    uint8_t i;
+
+    reset();
+    keys = SW_DOWN;
+    run(2000, 0);
+    run(0.5, 1);
+    CHECK(n_events == KEY_QUEUE_SIZE-1);
+    CHECK(events_got[0].ev == (KEY_PRESS | SW_DOWN));
+    CHECK(events_got[1].ev == (KEY_LONG | SW_DOWN));
+    for(i = 2; i < n_events; i++)
+    {
+        CHECK(events_got[i].ev == (KEY_REPEAT | SW_DOWN));
+    }
+    n_events = 0;
+    keys = 0;
+    run(100, 1);
+    CHECK(n_events == 1);
+    CHECK(events_got[0].ev == (KEY_RELEASE | SW_DOWN));
+}
+
+int main(void)
+{
+    sim.pin = &panel_pin;
+    timer_init();
+    io_init();
+    sei();
+
+    test_press_release();
+    test_bounce();
+    test_long_repeat();
+    test_two_keys();
+    test_overflow();
+    return TEST_RESULT();
+}
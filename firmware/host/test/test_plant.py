@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Run the firmware on the room model of host/plant.h for a day and check
+the summary it reports.
+
+The compressor only follows the coil temperature band while the humidity is
+above the reference. Applied all the time, the band makes it start some 12
+times an hour instead of about 2.
+"""
+
+import os
+import re
+import subprocess
+import sys
+import unittest
+
+MAIN = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                    "..", "..", "bin", "host", "main")
+HOURS = 24
+MAX_STARTS_PER_HOUR = 4
+
+
+class TestPlant(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(cls):
+        result = subprocess.run([MAIN, "-p", "-t", str(HOURS*3600)],
+                                stdout=subprocess.DEVNULL,
+                                stderr=subprocess.PIPE, text=True)
+        cls.report = result.stderr
+
+    def value(self, pattern):
+        match = re.search(pattern, self.report)
+        self.assertIsNotNone(match, pattern)
+        return float(match.group(1))
+
+    def test_compressor_starts(self):
+        starts = self.value(r"compressor .* (\d+) starts")
+        self.assertGreater(starts, 0)
+        self.assertLessEqual(starts, MAX_STARTS_PER_HOUR*HOURS)
+
+    def test_tracking(self):
+        self.assertLess(self.value(r"rms error ([\d.]+) %"), 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
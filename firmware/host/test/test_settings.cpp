@@ -0,0 +1,143 @@
+#include "settings.cpp"
+#include <util/delay.h>
+#include "sim.h"
+#include "test.h"
+
+/*Wear leveling and power fail safety of the settings log: records go round
+ *all slots, the newest one wins across the wraparound of the sequence
+ *number, and erased, corrupted or half written records are ignored.
+ */
+
+static void put_record(uint8_t slot, uint16_t seq, uint8_t value,
+                       uint8_t valid)
+/*Write a record straight into the EEPROM, with a wrong crc if !$valid
+ */
+{
+    settings_record r;
+
+    memset(&r, 0, sizeof(r));
+    r.seq = seq;
+    r.data[0] = value;
+    r.crc = record_crc(&r) ^ (valid ? 0 : 0x0100);
+    memcpy(&sim_eeprom[slot*SETTINGS_RECORD_SIZE], &r, sizeof(r));
+}
+
+static int16_t reboot(void)
+/*Find the newest record like after a reset, returns its first data byte,
+ *-1 if there's none
+ */
+{
+    uint8_t data[SETTINGS_DATA_SIZE];
+
+    settings_init();
+    if(settings_load(data, sizeof(data)) != 0)
+    {
+        return -1;
+    }
+    return data[0];
+}
+
+static void save(uint8_t value)
+{
+    uint8_t data[SETTINGS_DATA_SIZE] = {value};
+
+    CHECK(settings_save(data, sizeof(data)) == 0);
+    while(settings_busy())
+    {
+        _delay_ms(1);
+    }
+}
+
+static void test_erased(void)
+{
+    memset(sim_eeprom, 0xFF, SIM_EEPROM_SIZE);
+    CHECK(reboot() == -1);
+}
+
+static void test_wear_leveling(void)
+/*Every save goes to the next slot, round and round
+ */
+{
+    uint16_t i;
+    uint8_t slot;
+    settings_record r;
+
+    memset(sim_eeprom, 0xFF, SIM_EEPROM_SIZE);
+    reboot();
+    for(i = 0; i < SETTINGS_SLOTS + 3; i++)
+    {
+        save(i);
+        CHECK(reboot() == (uint8_t)i);
+    }
+    //every slot holds a record with the value of its last save
+    for(slot = 0; slot < SETTINGS_SLOTS; slot++)
+    {
+        memcpy(&r, &sim_eeprom[slot*SETTINGS_RECORD_SIZE], sizeof(r));
+        CHECK(r.crc == record_crc(&r));
+        CHECK(r.data[0] == (slot < 3 ? SETTINGS_SLOTS + slot : slot));
+    }
+    CHECK(current_slot == 2);
+
+    //unchanged settings aren't written again
+    memcpy(&r, &sim_eeprom[2*SETTINGS_RECORD_SIZE], sizeof(r));
+    save(SETTINGS_SLOTS + 2);
+    CHECK(current_slot == 2);
+    CHECK(memcmp(&r, &sim_eeprom[2*SETTINGS_RECORD_SIZE], sizeof(r)) == 0);
+}
+
+static void test_sequence_wraparound(void)
+{
+    memset(sim_eeprom, 0xFF, SIM_EEPROM_SIZE);
+    put_record(4, 0xFFFE, 10, 1);
+    put_record(5, 0xFFFF, 11, 1);
+    put_record(6, 0x0000, 12, 1);
+    put_record(7, 0x0001, 13, 1);
+    CHECK(reboot() == 13);
+    //the next save continues after the newest one
+    save(14);
+    CHECK(current_slot == 8);
+    CHECK(reboot() == 14);
+}
+
+static void test_crc(void)
+/*A record with a wrong crc doesn't count, even if it's the newest
+ */
+{
+    memset(sim_eeprom, 0xFF, SIM_EEPROM_SIZE);
+    put_record(0, 1, 20, 1);
+    put_record(1, 2, 21, 0);
+    CHECK(reboot() == 20);
+    put_record(0, 1, 20, 0);
+    CHECK(reboot() == -1);
+}
+
+static void test_torn_write(void)
+/*Power lost while the record is written: the previous one is still there
+ */
+{
+    uint8_t data[SETTINGS_DATA_SIZE] = {31};
+
+    memset(sim_eeprom, 0xFF, SIM_EEPROM_SIZE);
+    put_record(0, 1, 30, 1);
+    CHECK(reboot() == 30);
+    CHECK(settings_save(data, sizeof(data)) == 0);
+    //a few bytes, not the crc (written last)
+    _delay_ms(3*SIM_EEPROM_US/1000.0 + 1);
+    CHECK(settings_busy());
+    CHECK(reboot() == 30);
+    //and the next save overwrites the torn record
+    save(32);
+    CHECK(current_slot == 1);
+    CHECK(reboot() == 32);
+}
+
+int main(void)
+{
+    sei();
+    test_erased();
+    test_wear_leveling();
+    test_sequence_wraparound();
+    test_crc();
+    test_torn_write();
+    return TEST_RESULT();
+}
@@ -0,0 +1,186 @@
+#include "shell.cpp"
+#include <util/delay.h>
+#include "sim.h"
+#include "timer.h"
+#include "settings.h"
+#include "test.h"
+
+/*Command shell: replies to single commands, and to bursts of commands that
+ *come in faster than their replies can be sent. What the RX buffer can't
+ *take is lost, but never silently, and the shell answers normally again
+ *afterwards.
+ */
+
+static char out[4096];          //replies sent, without the 0 bytes
+static size_t out_len;
+static uint16_t out_ends;       //0 bytes ending a reply line
+
+static void host_tx(uint8_t c)
+{
+    if(c == '\0')
+    {
+        out_ends++;
+    }
+    else if(out_len < sizeof(out) - 1)
+    {
+        out[out_len++] = c;
+    }
+}
+
+static void send(const char* input)
+/*Receive $input at the baud rate, polling the shell every millisecond,
+ *until all replies are out. A byte takes 10 bit times.
+ */
+{
+    uint32_t ms = strlen(input)*10*1000/BAUD + 2000;
+
+    out_len = 0;
+    out_ends = 0;
+    memset(out, 0, sizeof(out));
+    sim_uart_rx((const uint8_t*)input, strlen(input));
+    while(ms-- != 0)
+    {
+        shell_poll();
+        _delay_ms(1);
+    }
+}
+
+static uint16_t count(const char* s)
+{
+    uint16_t n = 0;
+    const char* p = out;
+
+    while((p = strstr(p, s)) != NULL)
+    {
+        n++;
+        p += strlen(s);
+    }
+    return n;
+}
+
+static uint8_t ends_with(const char* s)
+{
+    return out_len >= strlen(s) && strcmp(out + out_len - strlen(s), s) == 0;
+}
+
+static uint8_t lines_ok(void)
+/*Every reply line is complete and one of the known kinds
+ */
+{
+    const char* p = out;
+    const char* nl;
+
+    while(*p != '\0')
+    {
+        nl = strstr(p, "\r\n");
+        if(nl == NULL)
+        {
+            return 0;
+        }
+        if(strncmp(p, "error: ", 7) != 0 && strncmp(p, "ok\r", 3) != 0
+           && memchr(p, '=', nl - p) == NULL)
+        {
+            return 0;
+        }
+        p = nl + 2;
+    }
+    return 1;
+}
+
+static void test_single(void)
+{
+    send("get ref_hum\n");
+    CHECK(strcmp(out, "ref_hum=50\r\n") == 0);
+    send("set ref_hum_var 4\r\n");
+    CHECK(strcmp(out, "ok\r\n") == 0);
+    send("get ref_hum_var\n");
+    CHECK(strcmp(out, "ref_hum_var=4\r\n") == 0);
+    send("set coil_loop_delay 16001\n");
+    CHECK(strcmp(out, "error: invalid value\r\n") == 0);
+    send("foo\n");
+    CHECK(strcmp(out, "error: unknown command\r\n") == 0);
+    send("get\n");
+    CHECK(count("\r\n") == param_count());
+    //every line is a block of its own for tools/telemetry_decode.py
+    CHECK(out_ends == param_count());
+}
+
+static void test_short_burst(void)
+/*Fits into the reply queue and the RX buffer, everything is answered
+ */
+{
+    send("set coil_loop_delay 16001\nsave\ntasks\nfoo\n");
+    CHECK(strcmp(out, "error: invalid value\r\nok\r\n"
+                      "error: unknown command\r\n") == 0);
+}
+
+static void test_lost_tail(void)
+/*The list of all parameters takes long to send, the RX buffer overflows
+ *behind it and the burst ends before anything else comes in
+ */
+{
+    send("get\nget ref_hum\nget ref_hum\nget ref_hum\nget ref_hum\n"
+         "get ref_hum\nget ref_hum\nget ref_hum\nget ref_hum\nfoo\n");
+    CHECK(lines_ok());
+    CHECK(count("ref_hum_var=") == 1);
+    CHECK(count("ref_hum=50\r\n") >= 2);
+    CHECK(count("ref_hum=50\r\n") < 9);
+    CHECK(count("error: input lost\r\n") == 1);
+    CHECK(ends_with("error: input lost\r\n"));
+    CHECK(count("unknown command") == 0);
+
+    send("get\nget ref_hum\nget ref_hum\nget ref_hum\nget ref_hum\n"
+         "get ref_hum\nset coil_loop_delay 16001\nsave\ntasks\nfoo\n");
+    CHECK(lines_ok());
+    //the lost tail of the burst before didn't take anything of this one
+    CHECK(count("ref_hum_var=") == 1);
+    CHECK(count("error: input lost\r\n") == 1);
+    CHECK(ends_with("error: input lost\r\n"));
+
+    //and everything is back to normal
+    send("get ref_hum\n");
+    CHECK(strcmp(out, "ref_hum=50\r\n") == 0);
+}
+
+static void test_long_burst(void)
+/*Goes on long after the overflow: nothing after the gap is executed up to
+ *the next line, the lines after that are answered as far as they fit
+ */
+{
+    static char input[1024];
+    uint8_t i;
+
+    strcpy(input, "get\n");
+    for(i = 0; i < 40; i++)
+    {
+        strcat(input, "get ref_hum\n");
+    }
+    strcat(input, "foo\n");
+    send(input);
+    CHECK(lines_ok());
+    CHECK(count("error: input lost\r\n") >= 1);
+    CHECK(count("ref_hum=50\r\n") >= 2);
+    //foo, if it made it, and no fragment of a line
+    CHECK(count("error: unknown command\r\n") == 0 ||
+          (count("error: unknown command\r\n") == 1 &&
+           ends_with("error: unknown command\r\n")));
+
+    send("get ref_hum\n");
+    CHECK(strcmp(out, "ref_hum=50\r\n") == 0);
+}
+
+int main(void)
+{
+    sim.tx = &host_tx;
+    timer_init();
+    uart_init();
+    settings_init();
+    param_init(NULL);
+    sei();
+
+    test_single();
+    test_short_burst();
+    test_lost_tail();
+    test_long_burst();
+    return TEST_RESULT();
+}
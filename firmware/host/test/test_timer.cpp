@@ -0,0 +1,214 @@
+#include "timer.cpp"
+#include <string.h>
+#include <util/delay.h>
+#include "sim.h"
+#include "test.h"
+
+/*Timer wheel: periodic and one-shot timers, deferred ones, catching up after
+ *the interrupt was held off, and how often the interrupt comes in tickless
+ *mode.
+ */
+
+static uint16_t calls[4];
+static uint32_t last_call[4];   //ticks processed at the last call
+
+#define TIMER_FUNC(n) static void count##n(void) { calls[n]++; last_call[n] = ticks; }
+TIMER_FUNC(0)
+TIMER_FUNC(1)
+TIMER_FUNC(2)
+TIMER_FUNC(3)
+
+static void wait_ticks(uint32_t n)
+{
+    sim_delay(n*TIMER_TICK);
+}
+
+static void reset(void)
+/*No timers registered, no calls counted
+ */
+{
+    int8_t id;
+
+    for(id = 0; id < TIMER_MAX; id++)
+    {
+        deregister_timer(id);
+    }
+    timer_dispatch();
+    memset(calls, 0, sizeof(calls));
+}
+
+static void test_periodic(void)
+{
+    reset();
+    CHECK(register_timer(&count0, 1*TIMER_TICK, 0) >= 0);
+    CHECK(register_timer(&count1, 3*TIMER_TICK, 0) >= 0);
+    CHECK(register_timer(&count2, 7*TIMER_TICK, 0) >= 0);
+    //more than a wheel turn
+    CHECK(register_timer(&count3, 40*TIMER_TICK, 0) >= 0);
+    wait_ticks(840);
+    CHECK(calls[0] == 840);
+    CHECK(calls[1] == 280);
+    CHECK(calls[2] == 120);
+    CHECK(calls[3] == 21);
+}
+
+static void test_register_errors(void)
+{
+    uint8_t i;
+
+    reset();
+    CHECK(register_timer(&count0, TIMER_TICK/2 - 1, 0) == -2);
+    CHECK(register_timer(&count0, (TIMER_IDLE_TICKS+1)*TIMER_TICK, 0) == -2);
+    for(i = 0; i < TIMER_MAX; i++)
+    {
+        CHECK(register_timer(&count0, 100*TIMER_TICK, 0) == i);
+    }
+    CHECK(register_timer(&count0, 100*TIMER_TICK, 0) == -1);
+}
+
+static void test_oneshot(void)
+{
+    int8_t id;
+
+    reset();
+    id = register_timer(&count0, 20*TIMER_TICK, TIMER_ONESHOT);
+    CHECK(id >= 0);
+    wait_ticks(19);
+    CHECK(calls[0] == 0);
+    wait_ticks(100);
+    CHECK(calls[0] == 1);
+    //freed after the call
+    CHECK(timers[id].interval == 0);
+
+    id = register_timer(&count1, 5*TIMER_TICK, TIMER_ONESHOT);
+    deregister_timer(id);
+    wait_ticks(10);
+    CHECK(calls[1] == 0);
+}
+
+static void test_deferred(void)
+/*Called by timer_dispatch(), once even if it expired several times
+ */
+{
+    reset();
+    register_timer(&count0, 2*TIMER_TICK, TIMER_DEFERRED);
+    wait_ticks(11);
+    CHECK(calls[0] == 0);
+    CHECK(pending != 0);
+    timer_dispatch();
+    CHECK(calls[0] == 1);
+    CHECK(pending == 0);
+    timer_dispatch();
+    CHECK(calls[0] == 1);
+}
+
+static void test_catch_up(void)
+/*Timers due while the interrupt was held off are called once when it's
+ *released, periodic ones skip the periods they missed and stay in phase
+ */
+{
+    uint32_t start;
+
+    reset();
+    start = timer_now();
+    register_timer(&count0, 2*TIMER_TICK, 0);
+    register_timer(&count1, 40*TIMER_TICK, 0);
+    register_timer(&count2, 1000*TIMER_TICK, 0);
+    timer_hold();
+    wait_ticks(101);
+    CHECK(calls[0] == 0);
+    timer_release();
+    sim_delay(TIMER_TICK/2);
+    CHECK(calls[0] == 1);
+    CHECK(calls[1] == 1);
+    CHECK(calls[2] == 0);
+    wait_ticks(99);
+    //at 102, 104 ... 200, and 120, 160, 200
+    CHECK(calls[0] == 1 + 50);
+    CHECK(calls[1] == 1 + 3);
+    CHECK(last_call[0] - start == 200);
+    CHECK(last_call[1] - start == 200);
+    wait_ticks(800);
+    CHECK(calls[2] == 1);
+    CHECK(last_call[2] - start == 1000);
+}
+
+static void test_from_callback(void)
+/*Functions may register and deregister timers, their own ones included
+ */
+{
+    reset();
+    register_timer(&count3, 5*TIMER_TICK, 0);
+    timer_hold();
+    wait_ticks(5);
+    //count3 is due, the next call to it mustn't happen
+    deregister_timer(0);
+    timer_release();
+    wait_ticks(20);
+    CHECK(calls[3] == 0);
+}
+
+static void test_tickless(void)
+/*The interrupt comes at the deadlines only, not every tick or wheel turn.
+ *Without any timer it comes every TIMER_IDLE_TICKS.
+ */
+{
+    uint32_t irqs;
+
+    reset();
+    register_timer(&count0, 100*TIMER_TICK, 0);
+    irqs = sim_interrupts;
+    wait_ticks(1000);
+    irqs = sim_interrupts - irqs;
+    CHECK(calls[0] == 10);
+#if TIMER_TICKLESS
+    CHECK(irqs >= 10 && irqs <= 11);
+#else
+    CHECK(irqs == 1000);
+#endif
+
+    reset();
+    irqs = sim_interrupts;
+    wait_ticks(4*TIMER_IDLE_TICKS);
+    irqs = sim_interrupts - irqs;
+#if TIMER_TICKLESS
+    CHECK(irqs >= 4 && irqs <= 5);
+#else
+    CHECK(irqs == 4*TIMER_IDLE_TICKS);
+#endif
+    //a timer registered while the alarm is far ahead is still on time
+    register_timer(&count1, 3*TIMER_TICK, TIMER_ONESHOT);
+    wait_ticks(2);
+    CHECK(calls[1] == 0);
+    wait_ticks(2);
+    CHECK(calls[1] == 1);
+}
+
+static void test_wraparound(void)
+/*The 16 bit counter runs over several times
+ */
+{
+    uint32_t now = timer_now();
+
+    reset();
+    register_timer(&count0, 1000*TIMER_TICK, 0);
+    wait_ticks(200000);
+    CHECK(calls[0] == 200);
+    CHECK(timer_now() - now == 200000);
+}
+
+int main(void)
+{
+    timer_init();
+    sei();
+
+    test_periodic();
+    test_register_errors();
+    test_oneshot();
+    test_deferred();
+    test_catch_up();
+    test_from_callback();
+    test_tickless();
+    test_wraparound();
+    return TEST_RESULT();
+}
@@ -0,0 +1,95 @@
+#include "warm.cpp"
+#include <string.h>
+#include "test.h"
+
+/*Warm restart block: only trusted after a reset that kept the RAM, and only
+ *if the magic number and the crc match.
+ */
+
+static const warm_state saved = {
+    .uptime = 123456789,
+    .hum = 553,
+    .ambient_temp = -42,
+    .state = 2,
+    .ref_hum = 55,
+};
+
+static uint8_t load(uint8_t cause, warm_state* s)
+{
+    memset(s, 0, sizeof(*s));
+    MCUCSR = cause;
+    return warm_load(s);
+}
+
+static uint8_t same(const warm_state* s)
+{
+    return s->uptime == saved.uptime && s->hum == saved.hum
+           && s->ambient_temp == saved.ambient_temp
+           && s->state == saved.state && s->ref_hum == saved.ref_hum;
+}
+
+static void test_never_saved(void)
+{
+    warm_state s;
+
+    memset(&block, 0, sizeof(block));
+    CHECK(load(1<<WDRF, &s) == 0);
+    memset(&block, 0xFF, sizeof(block));
+    CHECK(load(1<<EXTRF, &s) == 0);
+}
+
+static void test_reset_cause(void)
+/*Power-on and brown-out resets lose the RAM, whatever it reads like after
+ */
+{
+    warm_state s;
+
+    warm_save(&saved);
+    CHECK(load(1<<PORF, &s) == 0);
+    CHECK(MCUCSR == 0);
+    CHECK(load(1<<BORF, &s) == 0);
+    CHECK(load((1<<BORF) | (1<<WDRF), &s) == 0);
+    CHECK(load((1<<PORF) | (1<<EXTRF), &s) == 0);
+
+    CHECK(load(1<<WDRF, &s) == 1);
+    CHECK(same(&s));
+    CHECK(MCUCSR == 0);
+    CHECK(load(1<<EXTRF, &s) == 1);
+    CHECK(same(&s));
+    CHECK(load((1<<WDRF) | (1<<EXTRF), &s) == 1);
+    CHECK(same(&s));
+}
+
+static void test_damaged(void)
+/*A wrong byte anywhere, e.g. from a reset while warm_save() runs
+ */
+{
+    uint8_t* p = (uint8_t*)&block;
+    warm_state s;
+    uint8_t i;
+
+    //padding after the crc isn't covered
+    for(i = 0; i < offsetof(warm_block, crc) + sizeof(block.crc); i++)
+    {
+        warm_save(&saved);
+        p[i] ^= 0x10;
+        CHECK(load(1<<WDRF, &s) == 0);
+    }
+
+    warm_save(&saved);
+    block.magic = WARM_MAGIC ^ 1;
+    block.crc = block_crc();
+    CHECK(load(1<<WDRF, &s) == 0);
+
+    warm_save(&saved);
+    CHECK(load(1<<WDRF, &s) == 1);
+    CHECK(same(&s));
+}
+
+int main(void)
+{
+    test_never_saved();
+    test_reset_cause();
+    test_damaged();
+    return TEST_RESULT();
+}
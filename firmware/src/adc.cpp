@@ -0,0 +1,103 @@
+#include "common.h"
+#include "adc.h"
+#include "timer.h"
+
+static const uint8_t adc_channels[] = { ADC_CHANNEL_LIST };
+#define ADC_NCHANNELS (sizeof(adc_channels)/sizeof(adc_channels[0]))
+
+/*Results of the last complete round are in adc_buf[adc_front], the
+ *interrupt routine fills the other buffer and swaps them when it's done
+ *with all channels. So adc_get() never has to wait and all values it
+ *returns are from the same round.
+ */
+static uint16_t adc_buf[2][ADC_NCHANNELS];
+static volatile uint8_t adc_front;
+static volatile uint8_t adc_busy;   //round in progress
+
+static void mux_select_ch(uint8_t chnl)
+{
+    ADMUX = (ADMUX & ~((1<<MUX3)|(1<<MUX2)|(1<<MUX1)|(1<<MUX0)))
+            | (chnl & ((1<<MUX3)|(1<<MUX2)|(1<<MUX1)|(1<<MUX0)));
+}
+
+static void adc_round(void)
+/*Timer function (interrupt context), start a round through all channels
+ */
+{
+    if(adc_busy)
+    {
+        return;
+    }
+    adc_busy = 1;
+    mux_select_ch(adc_channels[0]);
+    setbit(ADCSRA, ADSC);
+}
+
+ISR(ADC_vect)
+/*Sum up ADC_OVERSAMPLE conversions of the current channel, then go on to the
+ *next one. The first conversion after switching channels is thrown away,
+ *the input might not have settled yet.
+ */
+{
+    static uint16_t sum;
+    static uint8_t count;   //conversions done on current channel
+    static uint8_t ch;      //index of current channel
+
+    if(count != 0)
+    {
+        sum += ADC;
+    }
+    if(++count <= ADC_OVERSAMPLE)
+    {
+        setbit(ADCSRA, ADSC);
+        return;
+    }
+    //else: this channel is done
+    adc_buf[adc_front ^ 1][ch] = sum >> ADC_EXTRA_BITS;
+    sum = 0;
+    count = 0;
+
+    if(++ch == ADC_NCHANNELS)
+    {
+        ch = 0;
+        adc_front ^= 1;
+        adc_busy = 0;
+        return;
+    }
+    mux_select_ch(adc_channels[ch]);
+    setbit(ADCSRA, ADSC);
+}
+
+void adc_init(void)
+{
+    //select AVCC as ADC Reference, results right adjusted (all 10 bits)
+    ADMUX = (0<<REFS1) | (1<<REFS0) | (0<<ADLAR);
+    //50 - 200 kHz needed, 1MHz provided -> prescaler: 16 -> 62.5kHz
+    //single conversions, started by adc_round() and the interrupt routine
+    ADCSRA = (1<<ADEN) | (0<<ADFR) | (1<<ADIE)
+             | (1<<ADPS2) | (0<<ADPS1) | (0<<ADPS0);
+
+    register_timer(&adc_round, TIMER_MS(ADC_PERIOD), 0);
+}
+
+uint16_t adc_get(uint8_t idx)
+/*Latest result of channel number $idx in ADC_CHANNEL_LIST, scaled to
+ *10+ADC_EXTRA_BITS bits. 0 until the first round is complete.
+ */
+{
+    return adc_buf[adc_front][idx];
+}
+
+void adc_suspend(void)
+/*Switch the ADC off, for standby. Suspend the timer first, so no new round
+ *is started, the one in progress is finished here.
+ */
+{
+    while(adc_busy);
+    clearbit(ADCSRA, ADEN);
+}
+
+void adc_resume(void)
+{
+    setbit(ADCSRA, ADEN);
+}
@@ -0,0 +1,29 @@
+#ifndef ADC_H
+#define ADC_H
+
+/*Background acquisition of the analog inputs. The channels in
+ *ADC_CHANNEL_LIST are converted in turn, every result is the sum of
+ *ADC_OVERSAMPLE conversions, decimated to 10+ADC_EXTRA_BITS bits.
+ */
+
+//ADC input channels to sample, in this order. ADCn is on pin PCn.
+#define ADC_CHANNEL_LIST    PIN_CTS::channel
+//index of each channel in ADC_CHANNEL_LIST, for adc_get()
+#define ADC_CTS             0   //cooling unit temperature sensor
+
+//resolution gained by oversampling; needs 4^n conversions per result
+#define ADC_EXTRA_BITS      2
+#define ADC_OVERSAMPLE      (1 << (2*ADC_EXTRA_BITS))
+#if ADC_EXTRA_BITS > 3
+#error "the sum of the conversions has to fit into 16 bits"
+#endif
+
+//a new round through all channels is started this often
+#define ADC_PERIOD          100 //ms
+
+void adc_init(void);
+uint16_t adc_get(uint8_t idx);
+void adc_suspend(void);
+void adc_resume(void);
+
+#endif
@@ -7,14 +7,14 @@
 #include <stdint.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <stdio.h>
 #include <stdlib.h>
+#include "pins.h"
 
 /*definitions common to all modules
  */
 
 extern uint8_t ref_hum; //humidity at which to start drying
-#define ref_hum_var 3   //stop drying at ref_hum-3
+extern uint8_t ref_hum_var;  //stop drying at ref_hum-ref_hum_var
 enum statev
 {
     off,
@@ -29,10 +29,4 @@ extern enum statev state;
 #define togglebit(byte, bit) ((byte) ^= ((1) << (bit)))
 #define testbit(byte, bit) (((byte) >> (bit)) & (1))    //returns 1 or 0
 
-//IC4.SCL:
-#define PORT_IOSCL  PORTD
-#define PIOSCL      PD3
-#define DDR_IOSCL   DDRD
-#define DDIOSCL     DDD3
-
 #endif
@@ -0,0 +1,163 @@
+#include "common.h"
+#include <avr/pgmspace.h>
+#include "control.h"
+#include "adc.h"
+#include "timer.h"
+#include "event.h"
+
+/*Water full sensor. The switch is on ICP1, so the input capture interrupt
+ *cuts the outputs the moment it trips, and they can't be started again while
+ *it reads full. water_full() only follows the switch once it read the same
+ *for WATER_QUALIFY, so a bouncing float doesn't flap the state.
+ */
+//checked this often by water_poll()
+#define WATER_POLL      10      //ms
+#define WATER_QUALIFY   500     //ms
+
+static volatile uint8_t water_level;    //qualified, returned by water_full()
+static volatile uint8_t water_count;    //polls the switch read differently
+
+ISR(TIMER1_CAPT_vect)
+/*Rising edge on the switch: the basin is full, or the float bounced
+ */
+{
+    PIN_COMP::low();
+    PIN_FAN::low();
+    //every edge starts the qualification over
+    water_count = 0;
+}
+
+static void water_poll(void)
+/*Runs in the timer interrupt and tells the main loop when water_full()
+ *changed, so it doesn't have to wait for its next pass.
+ */
+{
+    if(PIN_FULL::read() == water_level)
+    {
+        water_count = 0;
+        return;
+    }
+    if(++water_count == WATER_QUALIFY/WATER_POLL)
+    {
+        water_count = 0;
+        water_level ^= 1;
+        event_post(EV_SENSOR);
+    }
+}
+
+void control_init(void)
+{
+    PIN_FAN::output();
+    PIN_COMP::output();
+    //set the analog comparator AIN0 (PD6) to input. Should be around 4.1V
+    //clearbit(DDRD, DDD6); //just leave it there, shouldn't be set in the
+                            //first place
+
+    //cooling unit temperature is sampled in the background
+    adc_init();
+
+    //water full sensor
+    PIN_FULL::input();
+    PIN_FULL::high();         //enable pullup
+    register_timer(&water_poll, TIMER_MS(WATER_POLL), 0);
+    //capture rising edges, with the noise canceler. timer_init() set up the
+    //rest of TCCR1B already.
+    TCCR1B |= (1<<ICNC1) | (1<<ICES1);
+    TIFR = (1<<ICF1);
+    setbit(TIMSK, TICIE1);
+}
+
+/*Temperature in tenths of a C for every raw ADC value. The preprocessor
+ *expands TEMP_T256 to 256 constant expressions, which the compiler
+ *evaluates, so no floating point code ends up in the firmware.
+ */
+#define TEMP_CLAMP(x)   ((x) < TEMP_ADC_MIN ? TEMP_ADC_MIN : \
+                         (x) > TEMP_ADC_MAX ? TEMP_ADC_MAX : (x))
+#define TEMP_T(x)       (int16_t)(((TEMP_CAL_A*TEMP_CLAMP(x) + TEMP_CAL_B) \
+                                   * TEMP_CLAMP(x) + TEMP_CAL_C) * 10 + 0.5)
+#define TEMP_T4(x)      TEMP_T(x), TEMP_T(x+1), TEMP_T(x+2), TEMP_T(x+3)
+#define TEMP_T16(x)     TEMP_T4(x), TEMP_T4(x+4), TEMP_T4(x+8), TEMP_T4(x+12)
+#define TEMP_T64(x)     TEMP_T16(x), TEMP_T16(x+16), TEMP_T16(x+32), \
+                        TEMP_T16(x+48)
+#define TEMP_T256       TEMP_T64(0), TEMP_T64(64), TEMP_T64(128), TEMP_T64(192)
+
+static const int16_t temp_table[256] PROGMEM = { TEMP_T256 };
+
+static int16_t temp_celsius(uint8_t rawval)
+//convert raw ADC value to temperature in tenths of a C
+{
+    return((int16_t)pgm_read_word(&temp_table[rawval]));
+}
+
+//bits of the ADC results below the 8 bits indexing temp_table
+#define TEMP_FRAC_BITS  (ADC_EXTRA_BITS+2)
+
+int16_t temp_measure(void)
+/*Latest cooling unit temperature in tenths of a C. The ADC result is
+ *interpolated linearly between the two nearest table entries.
+ */
+{
+    uint16_t raw_adc = adc_get(ADC_CTS);
+    uint8_t idx = raw_adc >> TEMP_FRAC_BITS;
+    uint8_t frac = raw_adc & ((1<<TEMP_FRAC_BITS)-1);
+    int16_t t0 = temp_celsius(idx);
+
+    if(idx == 0xFF)
+    {
+        return(t0);
+    }
+    return(t0 + (((temp_celsius(idx+1)-t0) * frac) >> TEMP_FRAC_BITS));
+}
+
+//Fan control routines
+void start_fan(void)
+{
+    if(!PIN_FULL::read())
+    {
+        PIN_FAN::high();
+    }
+}
+
+void stop_fan(void)
+{
+    PIN_FAN::low();
+}
+
+void toggle_fan(void)
+{
+    PIN_FAN::toggle();
+}
+
+//Compressor control routines
+void start_comp(void)
+{
+    if(!PIN_FULL::read())
+    {
+        PIN_COMP::high();
+    }
+}
+
+void stop_comp(void)
+{
+    PIN_COMP::low();
+}
+
+void toggle_comp(void)
+{
+    PIN_COMP::toggle();
+}
+
+uint8_t water_full(void)
+/*1 if the basin is full, the switch has to read so for WATER_QUALIFY
+ */
+{
+    return(water_level);
+}
+
+uint8_t control_outputs(void)
+/*Current state of fan and compressor as OUT_* bits
+ */
+{
+    return(PIN_FAN::state() * OUT_FAN
+           | PIN_COMP::state() * OUT_COMP);
+}
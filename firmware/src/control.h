@@ -1,43 +1,30 @@
 #ifndef CONTROL_H
 #define CONTROL_H
 
-/*fan connection
+/*Calibration of the cooling unit temperature sensor, a polynominal fit of
+ *the temperature (C) over the 8 bit ADC value (see Curve_fitting.ods):
+ *  T = TEMP_CAL_A*x^2 + TEMP_CAL_B*x + TEMP_CAL_C
+ *The conversion table in control.cpp is computed from these at compile time.
  */
-//connected to PC0
-#define PORT_FAN    PORTC
-//pin number of fan in PORT_FAN
-#define PFAN        PC0
-#define DDR_FAN     DDRC
-#define DDFAN       DDC0
-
-/*compressor connection
- */
-//connected to PD4
-#define PORT_COMP   PORTD
-//pin number of compressor in PORT_COMP
-#define PCOMP       PD4
-#define DDR_COMP    DDRD
-#define DDCOMP      DDD4
-
-/*cooling unit temperature sensor
- */
-#define PORT_CTS    PORTC
-#define PCTS        PC1
-#define DDR_CTS     DDRC
-#define DDCTS       DDC1
-
-/*water full sensor
- */
-#define PORT_FULL   PORTB
-#define PIN_FULL    PINB
-#define PFULL       PB0
-#define DDR_FULL    DDRB
-#define DDFULL      DDB0
+#define TEMP_CAL_A      0.0004351878
+#define TEMP_CAL_B      0.2011721783
+//Should be -10.5522104343, just a quick fix to make measurement plausible.
+#define TEMP_CAL_C      -4.5522104343
+//range of the fit, values outside are clamped
+#define TEMP_ADC_MIN    70
+#define TEMP_ADC_MAX    230
+
+//bits returned by control_outputs()
+#define OUT_FAN     0x01
+#define OUT_COMP    0x02
 
 void control_init(void);
+uint8_t control_outputs(void);
 
-uint8_t temp_measure(void);
-//Fan control routines
+//cooling unit temperature in tenths of a degree celsius
+int16_t temp_measure(void);
+//Fan control routines. start_*() do nothing while the water full switch
+//reads full.
 void start_fan(void);
 void stop_fan(void);
 void toggle_fan(void);
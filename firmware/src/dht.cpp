@@ -0,0 +1,178 @@
+/*
+DHT Library 0x03
+
+copyright (c) Davide Gironi, 2012
+
+Released under GPLv3.
+Please refer to LICENSE file for licensing information.
+*/
+
+
+#include <string.h>
+
+#include "dht.h"
+#include "timer.h"
+
+/*
+ * A reading is done in two steps: dht_start() pulls the data line low and
+ * registers a one-shot timer, which releases it after the start pulse and
+ * reads the answer in dht_read(). The results are picked up later with the
+ * dht_get* functions, so nothing blocks for the length of the start pulse.
+ *
+ * The 40 bits are decoded by timing the high pulses with timer0. There is
+ * no edge interrupt on the data pin, so this is still done by polling, but
+ * only the timer interrupt (display multiplexing) is held off meanwhile.
+ * Other interrupts may still come in and make the reading fail its checksum,
+ * it is simply repeated next time.
+ */
+
+static uint8_t dht_bits[5];
+static uint8_t dht_busy;	//reading started, not finished yet
+static uint8_t dht_new;		//finished reading with valid checksum not
+				//fetched yet
+
+/*
+ * wait until the data line has the given level
+ */
+static int8_t dht_waitfor(uint8_t level) {
+	uint8_t start = TCNT0;
+
+	while(PIN_DHT::read() != level) {
+		if((uint8_t)(TCNT0 - start) > DHT_TIMEOUT) {
+			return -1; //timeout
+		}
+	}
+	return 0;
+}
+
+/*
+ * release the data line and read the answer of the sensor
+ */
+static void dht_read(void) {
+	uint8_t i,j = 0;
+	uint8_t start;
+	int8_t err = 0;
+
+	memset(dht_bits, 0, sizeof(dht_bits));
+
+	timer_hold();
+	//timer0 at F_CPU/8 for timing the pulses
+	TCCR0 = (0<<CS02) | (1<<CS01) | (0<<CS00);
+
+	PIN_DHT::high(); //high
+	PIN_DHT::input(); //input
+
+	//start condition: sensor pulls low for 80us, then high for 80us
+	err |= dht_waitfor(0);
+	err |= dht_waitfor(1);
+	err |= dht_waitfor(0);
+
+	//read the data
+	for (j=0; j<5 && !err; j++) { //read 5 byte
+		uint8_t result=0;
+		for(i=0; i<8 && !err; i++) {//read every bit
+			err |= dht_waitfor(1);
+			start = TCNT0;
+			err |= dht_waitfor(0);
+			if((uint8_t)(TCNT0 - start) > DHT_BIT_THRESHOLD) //long high pulse
+				result |= (1<<(7-i));
+		}
+		dht_bits[j] = result;
+	}
+
+	TCCR0 = 0;
+	timer_release();
+
+	//reset port
+	PIN_DHT::output(); //output
+	PIN_DHT::high(); //high
+
+	//check checksum
+	if (!err && (uint8_t)(dht_bits[0] + dht_bits[1] + dht_bits[2] + dht_bits[3]) == dht_bits[4]) {
+		dht_new = 1;
+	}
+	dht_busy = 0;
+}
+
+/*
+ * start a new reading
+ */
+int8_t dht_start(void) {
+	static uint32_t last_read;
+
+	//the sensor doesn't answer if asked too often
+	if(dht_busy || timer_now() - last_read < TIMER_TICKS(DHT_READ_INTERVAL)) {
+		return -1;
+	}
+
+	//reset port
+	//assume it was input before, then the data line is high as there's an
+	//external pullup
+	PIN_DHT::output(); //output
+	PIN_DHT::high(); //high
+
+	//send request
+	PIN_DHT::low(); //low
+	#if DHT_TYPE == DHT_DHT11
+	if(register_timer(&dht_read, TIMER_MS(18), TIMER_ONESHOT | TIMER_DEFERRED) < 0) {
+	#elif DHT_TYPE == DHT_DHT22
+	if(register_timer(&dht_read, TIMER_MS(10), TIMER_ONESHOT | TIMER_DEFERRED) < 0) {
+	#endif
+		PIN_DHT::high(); //high
+		return -1;
+	}
+
+	last_read = timer_now();
+	dht_busy = 1;
+	return 0;
+}
+
+/*
+ * get data of the last reading, in tenths
+ */
+int8_t dht_getdata(int16_t *temperature, int16_t *humidity) {
+	if(!dht_new) {
+		return -1;
+	}
+	dht_new = 0;
+
+	//return temperature and humidity
+	#if DHT_TYPE == DHT_DHT11
+	*temperature = dht_bits[2]*10;
+	*humidity = dht_bits[0]*10;
+	#elif DHT_TYPE == DHT_DHT22
+	//the sensor sends tenths already, temperature as sign and magnitude
+	uint16_t rawhumidity = dht_bits[0]<<8 | dht_bits[1];
+	uint16_t rawtemperature = dht_bits[2]<<8 | dht_bits[3];
+	if(rawtemperature & 0x8000) {
+		*temperature = -(int16_t)(rawtemperature & 0x7FFF);
+	} else {
+		*temperature = rawtemperature;
+	}
+	*humidity = rawhumidity;
+	#endif
+	return 0;
+}
+
+/*
+ * get temperature
+ */
+int8_t dht_gettemperature(int16_t *temperature) {
+	int16_t humidity = 0;
+	return dht_getdata(temperature, &humidity);
+}
+
+/*
+ * get humidity
+ */
+int8_t dht_gethumidity(int16_t *humidity) {
+	int16_t temperature = 0;
+	return dht_getdata(&temperature, humidity);
+}
+
+/*
+ * get temperature and humidity
+ */
+int8_t dht_gettemperaturehumidity(int16_t *temperature, int16_t *humidity) {
+	return dht_getdata(temperature, humidity);
+}
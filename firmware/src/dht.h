@@ -16,39 +16,29 @@ References:
 
 #include "common.h"
 
-//setup port
-#define DHT_DDR DDRB
-#define DHT_PORT PORTB
-#define DHT_PIN PINB
-#define DHT_INPUTPIN PB2
+//the data line is PIN_DHT in pins.h
 
 //sensor type
 #define DHT_DHT11 1
 #define DHT_DHT22 2
 #define DHT_TYPE DHT_DHT22
 
-//enable decimal precision (float)
+//all values are in tenths (of a degree celsius / percent relative humidity)
 
-//You MAY NOT enable this manually, DHT_FLOAT needs to be 0 for DHT11 and
-//1 for DHT22!!
-#if DHT_TYPE == DHT_DHT11
-#define DHT_FLOAT 0
-#elif DHT_TYPE == DHT_DHT22
-#define DHT_FLOAT 1
-#endif
+//timeouts and bit timing are measured with timer0 running at F_CPU/8
+#define DHT_US(us) ((us)*(F_CPU/1000000UL)/8)
+//longest time to wait for the data line to change (us)
+#define DHT_TIMEOUT DHT_US(150)
+//high pulses longer than this are 1 bits, shorter ones are 0 bits (us)
+#define DHT_BIT_THRESHOLD DHT_US(48)
 
-//timeout retries
-#define DHT_TIMEOUT 200
+//minimum time between two readings (and after power up), ms
+#define DHT_READ_INTERVAL 2000
 
 //functions
-#if DHT_FLOAT == 1
-extern int8_t dht_gettemperature(float *temperature);
-extern int8_t dht_gethumidity(float *humidity);
-extern int8_t dht_gettemperaturehumidity(float *temperature, float *humidity);
-#elif DHT_FLOAT == 0
-extern int8_t dht_gettemperature(int8_t *temperature);
-extern int8_t dht_gethumidity(int8_t *humidity);
-extern int8_t dht_gettemperaturehumidity(int8_t *temperature, int8_t *humidity);
-#endif
+extern int8_t dht_start(void);
+extern int8_t dht_gettemperature(int16_t *temperature);
+extern int8_t dht_gethumidity(int16_t *humidity);
+extern int8_t dht_gettemperaturehumidity(int16_t *temperature, int16_t *humidity);
 
 #endif
@@ -0,0 +1,31 @@
+#include "common.h"
+#include <avr/sleep.h>
+#include "event.h"
+
+volatile uint8_t events;
+
+uint8_t event_wait(void)
+/*Sleep (idle mode, so the timers and the UART keep running) until an event
+ *is posted. Returns all events posted since the last call.
+ */
+{
+    uint8_t ev;
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    cli();
+    while(events == 0)
+    {
+        sleep_enable();
+        //the instruction after sei is always executed before any interrupt,
+        //so an event posted right now still wakes us up
+        sei();
+        sleep_cpu();
+        sleep_disable();
+        cli();
+    }
+    ev = events;
+    events = 0;
+    sei();
+
+    return ev;
+}
@@ -0,0 +1,20 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+/*Events the main loop waits for. Interrupt routines post them, event_wait()
+ *sleeps until at least one was posted.
+ */
+#define EV_TIMER    0x01    //deferred timers pending, see timer_dispatch()
+#define EV_KEY      0x02    //switch on the IO panel pressed
+#define EV_UART     0x04    //byte received
+#define EV_SENSOR   0x08    //sensor reading changed
+#define EV_WAKE     0x10    //standby wake up, see standby.h
+
+extern volatile uint8_t events;
+
+//Only use in interrupt context, the read-modify-write isn't atomic
+#define event_post(ev) (events |= (ev))
+
+uint8_t event_wait(void);
+
+#endif
@@ -0,0 +1,69 @@
+#include "common.h"
+#include <avr/pgmspace.h>
+#include "fmt.h"
+#include "uart.h"
+
+static const uint16_t pow10[] PROGMEM = {10000, 1000, 100, 10, 1};
+#define FMT_DIGITS  (sizeof(pow10)/sizeof(pow10[0]))
+
+void fmt_char(char c)
+/*Like everything else written to the UART: dropped if the TX buffer is full,
+ *unless UART_TX_DROP is 0
+ */
+{
+#if UART_TX_DROP
+    uart_trywrite(c);
+#else
+    while(uart_trywrite(c) != 0);
+#endif
+}
+
+void fmt_str(const char* s)
+{
+    while(*s)
+    {
+        fmt_char(*s++);
+    }
+}
+
+void fmt_str_P(const char* s)
+/*String in flash, e.g. fmt_str_P(PSTR("text"))
+ */
+{
+    char c;
+
+    while((c = pgm_read_byte(s++)))
+    {
+        fmt_char(c);
+    }
+}
+
+void fmt_uint(uint16_t n)
+/*Decimal digits of $n, without leading zeros. At most 9 subtractions per
+ *digit, a lot cheaper than dividing by 10 on a cpu without a divider.
+ */
+{
+    uint8_t i;
+    uint16_t p;
+    char d;
+    uint8_t print = 0;
+
+    for(i = 0; i < FMT_DIGITS; i++)
+    {
+        p = pgm_read_word(&pow10[i]);
+        d = '0';
+        while(n >= p)
+        {
+            n -= p;
+            d++;
+        }
+        if(d != '0' || i == FMT_DIGITS-1)
+        {
+            print = 1;
+        }
+        if(print)
+        {
+            fmt_char(d);
+        }
+    }
+}
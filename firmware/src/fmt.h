@@ -0,0 +1,18 @@
+#ifndef FMT_H
+#define FMT_H
+
+/*Minimal formatted output straight into the UART TX buffer, instead of
+ *printf() and a stdio stream. Nothing is buffered in between, so write a
+ *line at once (check uart_txfree() first if it must not be cut off).
+ *Numbers are converted by subtracting powers of ten, no division.
+ */
+
+//line end to use in all output
+#define FMT_NL "\r\n"
+
+void fmt_char(char c);
+void fmt_str(const char* s);
+void fmt_str_P(const char* s);
+void fmt_uint(uint16_t n);
+
+#endif
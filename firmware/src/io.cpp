@@ -0,0 +1,614 @@
+#include "common.h"
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "timer.h"
+#include "io.h"
+#include "event.h"
+
+/*State of the outputs, as the patterns shifted out (0: on). The io_*
+ *functions below edit draft and copy it to the back buffer with
+ *frame_commit(), disp_cycle() only swaps buffers between two rounds through
+ *the outputs. So it never shows half of an update, and the main loop never
+ *writes what the interrupt is reading.
+ *Only call the io_* functions from the main loop (deferred timers included),
+ *not from interrupt routines.
+ */
+typedef struct Frame{
+    uint8_t leds;
+    uint8_t dis0;       //right digit
+    uint8_t dis1;       //left digit
+    uint8_t blink;      //LED_* and IO_BLINK_DIS, off every other period
+} frame;
+
+#define FRAME_BLANK {0xFF, 0xFF, 0xFF, 0}
+
+static frame frames[2] = {FRAME_BLANK, FRAME_BLANK};
+static volatile uint8_t front;      //index of the frame disp_cycle() shows
+static volatile uint8_t swap;       //the other one is new, show it next
+static frame draft = FRAME_BLANK;
+static volatile uint8_t blink_off;  //blinking outputs are off right now
+
+//time each ticker position is shown, and half the blink period
+#define IO_ANIMATE_PERIOD   500 //ms
+//disp_cycle() runs every IO_CYCLE_TICKS and goes through IO_CYCLE_STEPS
+//steps per round: LEDs, right digit, left digit, keys
+#define IO_CYCLE_TICKS      1
+#define IO_CYCLE_STEPS      4
+
+//scrolling text, see io_ticker_P()
+static const char* ticker_str;      //in flash, NULL if not running
+static uint8_t ticker_pos;          //next character
+static uint8_t ticker_tail;         //steps since the end of the text
+static uint8_t ticker_flags;
+static uint8_t ticker_dis0;         //digits to show after the ticker
+static uint8_t ticker_dis1;
+
+
+//Bitpatterns for 7 segment digits
+uint8_t dis_digits[] = {
+    (uint8_t)~0x3F,   //'0'
+    (uint8_t)~0x06,   //'1'
+    (uint8_t)~0x5B,   //'2'
+    (uint8_t)~0x4F,   //'3'
+    (uint8_t)~0x66,   //'4'
+    (uint8_t)~0x6D,   //'5'
+    (uint8_t)~0x7D,   //'6'
+    (uint8_t)~0x07,   //'7'
+    (uint8_t)~0x7F,   //'8'
+    (uint8_t)~0x6F    //'9'
+};
+
+//Bitpatterns for 7 segment letters
+uint8_t dis_letters[] = {
+    (uint8_t)~0x77,  //'A'
+    (uint8_t)~0x7C,  //'B'
+    (uint8_t)~0x39,  //'C'
+    (uint8_t)~0x5E,  //'D'
+    (uint8_t)~0x79,  //'E'
+    (uint8_t)~0x71,  //'F'
+    (uint8_t)~0x6F,  //'G' like '9'
+    (uint8_t)~0x76,  //'H' like 'X'
+    (uint8_t)~0x10,  //'I'
+    (uint8_t)~0x1F,  //'J'
+    (uint8_t)~0x78,  //'K'
+    (uint8_t)~0x38,  //'L'
+    (uint8_t)~0x37,  //'M' cripple
+    (uint8_t)~0x54,  //'N'
+    (uint8_t)~0x3F,  //'O' like '0'
+    (uint8_t)~0x73,  //'P'
+    (uint8_t)~0x67,  //'Q'
+    (uint8_t)~0x50,  //'R'
+    (uint8_t)~0x6D,  //'S' like '5'
+    (uint8_t)~0x31,  //'T'
+    (uint8_t)~0x3E,  //'U'
+    (uint8_t)~0x1C,  //'V'
+    (uint8_t)~0x3C,  //'W' cripple
+    (uint8_t)~0x76,  //'X' like 'H'
+    (uint8_t)~0x70,  //'Y'
+    (uint8_t)~0x5B   //'Z' like '2'
+};
+
+static uint8_t dischar(char letter)
+/*Return 7 segment state of any of the characters we have defined above
+ */
+{
+    if(letter >= 'a' && letter <= 'z')
+    {
+        //convert to upper
+        letter -= 'a'-'A';
+    }
+    if(letter >= 'A' && letter <= 'Z')
+    {
+        return dis_letters[letter-'A'];
+    }
+    else if (letter >= '0' && letter <= '9')
+    {
+        return dis_digits[letter-'0'];
+    }
+    else
+    {
+        return (uint8_t)~0x00;
+    }
+}
+
+/*There's a transistor between the AVR pin and the LEDC pin, so our signal
+ *get's inverted.
+ */
+
+static void set_LEDC()
+{
+    PIN_IOLED::low();
+}
+
+static void clear_LEDC()
+{
+    PIN_IOLED::high();
+}
+
+/*There's a transistor between the AVR pin and the pin of the 7-segment
+ *dispaly, so our signal get's inverted.
+ */
+
+static void set_DIS0()
+{
+    PIN_IODIS0::low();
+}
+
+static void clear_DIS0()
+{
+    PIN_IODIS0::high();
+}
+
+static void set_DIS1()
+{
+    PIN_IODIS1::low();
+}
+
+static void clear_DIS1()
+{
+    PIN_IODIS1::high();
+}
+
+/*One bit of $value into the shift register of the IO panel (IC5), bit $n
+ *has to be a constant. DAT is cleared and set again if the bit is set, then
+ *CLK is pulsed, "clocking occurs on the low-to-high-level transition".
+ *Written so it can become cbi, sbrc, sbi, sbi, cbi without a branch, some
+ *8 cycles. The compiler output wasn't checked yet, make bench measures it.
+ *DAT only matters at the rising edge of CLK, and the shift register needs
+ *pulses of some 20 ns, a cycle is 1 us.
+ */
+#define SHIFTR_BIT(value, n)        \
+    do                              \
+    {                               \
+        PIN_IODAT::low();         \
+        if((value) & (1<<(n)))      \
+        {                           \
+            PIN_IODAT::high();    \
+        }                           \
+        PIN_IOCLK::high();        \
+        PIN_IOCLK::low();         \
+    } while(0)
+
+static void shiftr_setval(uint8_t value)
+/*Pushes the given value into the shift register of the IO panel (IC5), MSB
+ *first. CLK has to be low.
+ *We don't do any abstraction between this and setting 7seg / LED patterns
+ */
+{
+    SHIFTR_BIT(value, 7);
+    SHIFTR_BIT(value, 6);
+    SHIFTR_BIT(value, 5);
+    SHIFTR_BIT(value, 4);
+    SHIFTR_BIT(value, 3);
+    SHIFTR_BIT(value, 2);
+    SHIFTR_BIT(value, 1);
+    SHIFTR_BIT(value, 0);
+}
+
+static uint8_t io_switches_raw(void)
+/*Test the switches SW1 to SW4 and returns ored states
+ *Each switch connects KEY to one of the outputs of the shift register, so
+ *one output after the other is pulled low: ~0x01, ~0x02, ~0x04, ~0x08.
+ *Every pattern is the last one shifted by one bit with a one coming in, so
+ *only the first one needs all 8 bits, the others a single one.
+ */
+{
+    //we don't need to clear LEDC, DIS0, DIS1, disp_cycle just did that.
+    uint8_t swstate;
+
+    shiftr_setval(~0x01);                       //SW1
+    swstate = !PIN_IOKEY::read();
+    SHIFTR_BIT(0xFF, 0);                        //SW2
+    swstate |= !PIN_IOKEY::read() << 1;
+    SHIFTR_BIT(0xFF, 0);                        //SW3
+    swstate |= !PIN_IOKEY::read() << 2;
+    SHIFTR_BIT(0xFF, 0);                        //SW4
+    swstate |= !PIN_IOKEY::read() << 3;
+    return(swstate);
+}
+
+/*Key engine. key_scan() runs in the interrupt once per round of disp_cycle()
+ *and only debounces and queues events, io_switch_handler() acts on them in
+ *the main loop. Every key has an integrator counting up while it reads
+ *pressed and down otherwise, it only changes state at the ends of the range.
+ */
+//convert milliseconds to scans, once per round of disp_cycle()
+#define KEY_SCANS(ms)       (TIMER_TICKS(ms)/(IO_CYCLE_TICKS*IO_CYCLE_STEPS))
+//integrator range, a bouncing key needs about this long to change state
+#define KEY_INTEGRATE       KEY_SCANS(20)
+//held this long for KEY_LONG, then a KEY_REPEAT every KEY_REPEAT_DELAY
+#define KEY_LONG_DELAY      800     //ms
+#define KEY_REPEAT_DELAY    150     //ms
+//queued events, has to be a power of two (one entry stays unused)
+#define KEY_QUEUE_SIZE      8
+
+#if KEY_SCANS(KEY_LONG_DELAY) > 255 || KEY_INTEGRATE == 0
+#error "key timing doesn't fit the 8 bit counters"
+#endif
+
+static uint8_t key_count[4];    //integrators, 0 to KEY_INTEGRATE
+static uint8_t key_held[4];     //scans until the next KEY_LONG/KEY_REPEAT
+static uint8_t keys_down;       //debounced state, SW_* bits
+static uint8_t keys_long;       //KEY_LONG was sent for these
+
+/*Ring buffer like the ones in uart.cpp, key_scan() owns the head,
+ *io_key_get() the tail. Empty if head == tail.
+ */
+static uint8_t key_queue[KEY_QUEUE_SIZE];
+static volatile uint8_t key_head;
+static volatile uint8_t key_tail;
+
+static void key_post(uint8_t ev)
+/*Queue an event, interrupt context only. Dropped if the queue is full, the
+ *main loop is way behind then anyway.
+ */
+{
+    uint8_t next = (key_head + 1) & (KEY_QUEUE_SIZE-1);
+
+    if(next != key_tail)
+    {
+        key_queue[key_head] = ev;
+        key_head = next;
+    }
+    event_post(EV_KEY);
+}
+
+static void key_scan(void)
+/*Called from disp_cycle() in interrupt context, so only find out what
+ *happened and leave the rest to io_switch_handler().
+ */
+{
+    uint8_t raw = io_switches_raw();
+    uint8_t i, sw;
+
+    for(i = 0, sw = 0x01; i < 4; i++, sw <<= 1)
+    {
+        if(raw & sw)
+        {
+            if(key_count[i] < KEY_INTEGRATE)
+            {
+                key_count[i]++;
+            }
+        }
+        else if(key_count[i] > 0)
+        {
+            key_count[i]--;
+        }
+
+        if(!(keys_down & sw))
+        {
+            if(key_count[i] == KEY_INTEGRATE)
+            {
+                keys_down |= sw;
+                key_held[i] = KEY_SCANS(KEY_LONG_DELAY);
+                key_post(KEY_PRESS | sw);
+            }
+        }
+        else if(key_count[i] == 0)
+        {
+            keys_down &= ~sw;
+            keys_long &= ~sw;
+            key_post(KEY_RELEASE | sw);
+        }
+        else if(--key_held[i] == 0)
+        {
+            key_post((keys_long & sw ? KEY_REPEAT : KEY_LONG) | sw);
+            keys_long |= sw;
+            key_held[i] = KEY_SCANS(KEY_REPEAT_DELAY);
+        }
+    }
+}
+
+uint8_t io_key_get(void)
+/*Next key event, one of KEY_* ored with the SW_* bit of the key, 0 if there
+ *is none. Not for interrupt context, there's only one reader.
+ */
+{
+    uint8_t ev;
+
+    if(key_head == key_tail)
+    {
+        return 0;
+    }
+    ev = key_queue[key_tail];
+    key_tail = (key_tail + 1) & (KEY_QUEUE_SIZE-1);
+    return ev;
+}
+
+void io_switch_handler(void)
+/*Act on key events. Called from the main loop on EV_KEY.
+ *UP and DOWN step the reference humidity on every press and keep stepping
+ *while held, the others act on presses only.
+ */
+{
+    uint8_t ev;
+
+    while((ev = io_key_get()) != 0)
+    {
+        if(ev == (KEY_PRESS | SW_ONOFF))
+        {
+            //the main loop goes to standby, which waits for it to be
+            //switched on again
+            state = off;
+        }
+        if(state == off || (ev & KEY_RELEASE))
+        {
+            continue;
+        }
+        if(KEY_SW(ev) == SW_UP)
+        {
+            if(ref_hum < 99)
+            {
+                io_print_nbr(++ref_hum);
+            }
+        }
+        if(KEY_SW(ev) == SW_DOWN)
+        {
+            if(ref_hum > ref_hum_var)
+            {
+                io_print_nbr(--ref_hum);
+            }
+        }
+        if(ev == (KEY_PRESS | SW_CONT))
+        {
+            if(state == waterfull)
+            {
+                state = ok;
+            }
+        }
+    }
+}
+
+void disp_cycle(void)
+/*This routine is responsible for cycling through the different outputs, as we
+ *can only do output on one of {LEDs, DIS0, DIS1} or input of the switches at
+ *the same time.
+ */
+{
+    static volatile uint8_t curr_state;  //current state
+    const frame* f;
+    uint8_t off;
+
+    //turn everything off
+    clear_LEDC();
+    clear_DIS0();
+    clear_DIS1();
+    if(curr_state == 0 && swap)
+    {
+        front ^= 1;
+        swap = 0;
+    }
+    f = &frames[front];
+    off = blink_off ? f->blink : 0;
+    //turn on depending on current state
+    switch(curr_state)
+    {
+        case 0:
+            shiftr_setval(f->leds | (off & ~IO_BLINK_DIS));
+            set_LEDC();
+            break;
+        case 1:
+            shiftr_setval(f->dis0);
+            if(!(off & IO_BLINK_DIS))
+            {
+                set_DIS0();
+            }
+            break;
+        case 2:
+            shiftr_setval(f->dis1);
+            if(!(off & IO_BLINK_DIS))
+            {
+                set_DIS1();
+            }
+            break;
+        case 3:
+            key_scan();
+            break;
+    }
+
+    if(++curr_state == IO_CYCLE_STEPS)
+    {
+        curr_state = 0;
+    }
+}
+
+static void frame_commit(void)
+/*Hand draft over to disp_cycle(), it's shown from the next round on. The
+ *back buffer isn't read by the interrupt, only the flag has to be set
+ *together with the copy.
+ */
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        frames[front ^ 1] = draft;
+        swap = 1;
+    }
+}
+
+static void show_digits(uint8_t dis0, uint8_t dis1)
+/*Put the patterns on the 7 segment displays, or keep them for after the
+ *ticker if it's running
+ */
+{
+    if(ticker_str != NULL)
+    {
+        ticker_dis0 = dis0;
+        ticker_dis1 = dis1;
+    }
+    else if(draft.dis0 != dis0 || draft.dis1 != dis1)
+    {
+        draft.dis0 = dis0;
+        draft.dis1 = dis1;
+        frame_commit();
+    }
+}
+
+static void ticker_step(void)
+/*Scroll the text one character to the left
+ */
+{
+    char c = pgm_read_byte(ticker_str + ticker_pos);
+
+    draft.dis1 = draft.dis0;
+    draft.dis0 = dischar(c);    //blank after the end
+    if(c != 0)
+    {
+        ticker_pos++;
+    }
+    else if(++ticker_tail == 2)
+    {
+        //the last character went out on the left
+        ticker_pos = 0;
+        ticker_tail = 0;
+        if(!(ticker_flags & IO_TICKER_LOOP))
+        {
+            io_ticker_stop();
+            return;
+        }
+    }
+    frame_commit();
+}
+
+static void io_animate(void)
+/*Deferred timer, every IO_ANIMATE_PERIOD
+ */
+{
+    blink_off = !blink_off;
+    if(ticker_str != NULL)
+    {
+        ticker_step();
+    }
+}
+
+void io_set_LEDs(uint8_t st)
+/*Set the LEDs according to the given state (probably ored LED_*)
+ */
+{
+    uint8_t leds = ~st;
+
+    if(draft.leds != leds)
+    {
+        draft.leds = leds;
+        frame_commit();
+    }
+}
+
+void io_blink(uint8_t mask)
+/*Let the outputs in $mask (ored LED_*, IO_BLINK_DIS for both displays)
+ *blink, while they're on. 0 stops blinking.
+ */
+{
+    if(draft.blink != mask)
+    {
+        draft.blink = mask;
+        frame_commit();
+    }
+}
+
+void io_ticker_P(const char* str, uint8_t flags)
+/*Scroll the text $str (in flash) through the two 7 segments, one character
+ *every IO_ANIMATE_PERIOD, starting on the right. Doesn't wait for it, the
+ *text has to stay valid until it's done. With IO_TICKER_LOOP in $flags it
+ *starts over until io_ticker_stop(). Numbers printed in the meantime are
+ *shown afterwards.
+ */
+{
+    if(ticker_str == NULL)
+    {
+        ticker_dis0 = draft.dis0;
+        ticker_dis1 = draft.dis1;
+    }
+    ticker_str = str;
+    ticker_pos = 0;
+    ticker_tail = 0;
+    ticker_flags = flags;
+    draft.dis0 = 0xFF;
+    ticker_step();
+}
+
+void io_ticker_stop(void)
+/*Stop scrolling and show what was printed before or in the meantime
+ */
+{
+    if(ticker_str != NULL)
+    {
+        ticker_str = NULL;
+        show_digits(ticker_dis0, ticker_dis1);
+    }
+}
+
+void io_init(void)
+{
+    PIN_IOCLK::output();
+    PIN_IODAT::output();
+    PIN_IOKEY::input();
+    PIN_IOLED::output();
+    PIN_IODIS0::output();
+    PIN_IODIS1::output();
+
+    PIN_IOCLK::low();             //low by default
+
+    clear_LEDC();
+    clear_DIS0();
+    clear_DIS1();
+
+    register_timer(&disp_cycle, IO_CYCLE_TICKS*TIMER_TICK, 0);
+    register_timer(&io_animate, TIMER_MS(IO_ANIMATE_PERIOD), TIMER_DEFERRED);
+
+    io_print_nbr(ref_hum);
+    io_set_LEDs(LED_ONOFF);
+}
+
+void io_suspend(void)
+/*Switch the panel off for standby, once disp_cycle() doesn't run anymore.
+ *io_switches() can read the keys meanwhile.
+ */
+{
+    clear_LEDC();
+    clear_DIS0();
+    clear_DIS1();
+}
+
+void io_resume(void)
+/*Back from standby, before disp_cycle() runs again. Keys held right now
+ *count as pressed already, so the one that switched the unit on doesn't
+ *send another KEY_PRESS when the key engine picks up again.
+ */
+{
+    uint8_t raw = io_switches();
+    uint8_t i, sw;
+
+    for(i = 0, sw = 0x01; i < 4; i++, sw <<= 1)
+    {
+        if(raw & sw)
+        {
+            key_count[i] = KEY_INTEGRATE;
+            key_held[i] = KEY_SCANS(KEY_LONG_DELAY);
+            keys_down |= sw;
+        }
+    }
+}
+
+uint8_t io_switches(void)
+/*Switches pressed right now (SW_* bits), not debounced. Only for standby,
+ *it shifts patterns into the panel that disp_cycle() doesn't expect.
+ */
+{
+    return(io_switches_raw());
+}
+
+void io_print_nbr(uint8_t nbr)
+/*Print number between 0 and 99 on 7-segment display.
+ *Clears display if the given number is not in that range.
+ */
+{
+    if(nbr > 99)
+    {
+        show_digits(0xFF, 0xFF);
+    }
+    else
+    {
+        show_digits(dis_digits[nbr%10], dis_digits[nbr/10]);
+    }
+}
+
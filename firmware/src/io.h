@@ -1,39 +1,8 @@
 #ifndef IO_H
 #define IO_H
 
-/*input/output panel connections
+/*input/output panel, connected to the PIN_IO* pins of pins.h
  */
-//CLK: 
-#define PORT_IOCLK  PORTD
-#define PIOCLK      PD2
-#define DDR_IOCLK   DDRD
-#define DDIOCLK     DDD2
-//DAT:
-#define PORT_IODAT  PORTC
-#define PIODAT      PC5
-#define DDR_IODAT   DDRC
-#define DDIODAT     DDC5
-//KEY:
-#define PORT_IOKEY  PORTC
-#define PIN_IOKEY   PINC
-#define PIOKEY      PC4
-#define DDR_IOKEY   DDRC
-#define DDIOKEY     DDC4
-//LEDC:
-#define PORT_IOLED  PORTD
-#define PIOLED      PD7
-#define DDR_IOLED   DDRD
-#define DDIOLED     DDD7
-//DIS0:
-#define PORT_IODIS0 PORTB
-#define PIODIS0     PB6
-#define DDR_IODIS0  DDRB
-#define DDIODIS0    DDB6
-//DIS1:
-#define PORT_IODIS1 PORTB
-#define PIODIS1     PB7
-#define DDR_IODIS1  DDRB
-#define DDIODIS1    DDB7
 
 //Three LEDs on the IO panel:
 #define LED_ONOFF   0x01
@@ -46,8 +15,29 @@
 #define SW_UP       0x04
 #define SW_CONT     0x08
 
+//Key events of io_key_get(), ored with the SW_* bit of the key
+#define KEY_PRESS   0x10
+#define KEY_RELEASE 0x20
+#define KEY_LONG    0x40    //held for a while
+#define KEY_REPEAT  0x80    //still held, again and again after KEY_LONG
+#define KEY_SW(ev)  ((ev) & 0x0F)
+
+//io_blink(): both 7 segment displays
+#define IO_BLINK_DIS    0x80
+//io_ticker_P() options
+//start over at the end, until io_ticker_stop()
+#define IO_TICKER_LOOP  0x01
+
 void io_init(void);
 void io_set_LEDs(uint8_t st);
 void io_print_nbr(uint8_t nbr);
+void io_blink(uint8_t mask);
+void io_ticker_P(const char* str, uint8_t flags);
+void io_ticker_stop(void);
+void io_suspend(void);
+void io_resume(void);
+uint8_t io_switches(void);
+uint8_t io_key_get(void);
+void io_switch_handler(void);
 
 #endif
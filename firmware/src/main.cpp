@@ -0,0 +1,313 @@
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include "io.h"
+#include "common.h"
+#include "timer.h"
+#include "uart.h"
+#include "control.h"
+#include "dht.h"
+#include "event.h"
+#include "settings.h"
+#include "telemetry.h"
+#include "param.h"
+#include "shell.h"
+#include "standby.h"
+#include "warm.h"
+#include "task.h"
+
+//visible in all modules as declared in common.h
+uint8_t ref_hum;
+uint8_t ref_hum_var;
+enum statev state = ok;
+
+//where older firmware kept the reference humidity
+#define EEPROM_REF_HUM_OLD (uint8_t*)0x00
+
+//latest readings, in tenths of a percent / degree celsius
+static int16_t hum;
+static int16_t ambient_temp;
+
+//tasks run ahead of time by control()
+static int8_t hum_task = -1;
+static int8_t disp_task = -1;
+
+static void dht_update(void)
+/*Start a new reading, dht_fetch() picks up the result when it's done
+ */
+{
+    dht_start();
+}
+
+static void dht_fetch(void)
+{
+    //only updates if successful
+    dht_gettemperaturehumidity(&ambient_temp, &hum);
+}
+
+static void ref_hum_save(void)
+/*Only writes to the EEPROM if the value changed, and doesn't block. Other
+ *parameters are only saved on request, see shell.h.
+ */
+{
+    param_save_value(&ref_hum);
+}
+
+static void warm_update(void)
+/*Keep the state for a warm restart up to date
+ */
+{
+    warm_state w;
+
+    w.uptime = timer_now();
+    w.hum = hum;
+    w.ambient_temp = ambient_temp;
+    w.state = state;
+    w.ref_hum = ref_hum;
+    warm_save(&w);
+}
+
+static void telemetry_update(void)
+{
+    telemetry t;
+
+    t.hum = hum;
+    t.ambient_temp = ambient_temp;
+    t.coil_temp = temp_measure();
+    t.outputs = control_outputs();
+    t.state = state;
+    t.ref_hum = ref_hum;
+    telemetry_send(&t);
+}
+
+static void hum_loop(void)
+/*Slow loop: dry while the humidity is above the reference, until it's
+ *ref_hum_var below. The compressor follows the fan in coil_loop().
+ */
+{
+    switch(state)
+    {
+    case ok:
+        if(hum > ref_hum*10)
+        {
+            start_fan();
+        }
+        else if(hum < (ref_hum-ref_hum_var)*10)
+        {
+            stop_comp();
+            stop_fan();
+        }
+        if(water_full())
+        {
+            stop_comp();
+            stop_fan();
+            state = waterfull;
+        }
+        break;
+    case waterfull:
+        break;
+    case off:
+        stop_comp();
+        stop_fan();
+    }
+    warm_update();
+}
+
+static void coil_loop(void)
+/*Fast loop: while the humidity is above the reference, keep the cooling
+ *unit between ref_tdiff_l and ref_tdiff_h degrees below the ambient
+ *temperature. It reacts to the coil temperature within coil_loop_delay, no
+ *matter how slow the humidity loop is. On the way down to ref_hum-ref_hum_var
+ *the compressor keeps its state, like it did in control() before. The
+ *humidity loop and the water full interrupt stop it on their own.
+ */
+{
+    int16_t tempdiff;   //temperature diff of air and cooling unit (tenths)
+
+    if(state != ok || hum <= ref_hum*10 || !(control_outputs() & OUT_FAN))
+    {
+        return;
+    }
+    tempdiff = ambient_temp-temp_measure();
+    if(tempdiff < ref_tdiff_l*10)
+    {
+        start_comp();
+    }
+    else if(tempdiff > ref_tdiff_h*10)
+    {
+        stop_comp();
+    }
+}
+
+static void display(void)
+/*LEDs and digits for the current state. The reference humidity is shown
+ *again every time, it might have been changed over the UART.
+ */
+{
+    static enum statev shown = ok;  //state the display was set up for
+
+    switch(state)
+    {
+    case waterfull:
+        io_set_LEDs(LED_ONOFF | LED_WATER);
+        io_blink(LED_WATER);
+        io_print_nbr(ref_hum);
+        break;
+    case ok:
+        io_set_LEDs(LED_ONOFF);
+        io_blink(0);
+        io_print_nbr(ref_hum);
+        break;
+    case off:
+        io_set_LEDs(0);
+        io_blink(0);
+        io_print_nbr(100);  //clear display
+    }
+
+    //scroll FULL through the displays until the basin was emptied, the
+    //reference humidity comes back afterwards
+    if(state != shown)
+    {
+        if(state == waterfull)
+        {
+            io_ticker_P(PSTR("FULL"), IO_TICKER_LOOP);
+        }
+        else
+        {
+            io_ticker_stop();
+        }
+        shown = state;
+    }
+}
+
+static void control(void)
+/*Don't wait for the next runs of the humidity loop and the display
+ */
+{
+    task_run(hum_task);
+    task_run(disp_task);
+}
+
+static void standby(void)
+/*Switched off: wait in standby until ON/OFF is pressed, then carry on with
+ *the settings and timers as they were.
+ */
+{
+    uint8_t ev;
+    uint8_t pressed = 0;
+
+    standby_enter();
+    while(pressed < STANDBY_PRESSED)
+    {
+        ev = event_wait();
+        if(ev & EV_WAKE)
+        {
+            pressed = io_switches() & SW_ONOFF ? pressed + 1 : 0;
+        }
+        //the shell still answers
+        shell_poll();
+    }
+    standby_leave();
+
+    state = ok;
+    control();
+}
+
+void init(void) {
+    warm_state w;
+    uint8_t warm = warm_load(&w);
+
+    uart_init();
+
+    //initialize timer (needed by all the modules registering timers)
+    timer_init();
+    if(warm)
+    {
+        timer_continue(w.uptime);
+    }
+
+    control_init();
+
+    //initialize input/output panel
+    io_init();
+
+    //read reference humidity and other parameters stored in eeprom
+    settings_init();
+    if(param_init(&task_schedule) != 0)
+    {
+        //nothing saved yet, maybe there's a value from older firmware
+        ref_hum = eeprom_read_byte(EEPROM_REF_HUM_OLD);
+        if(ref_hum > 99)
+        {
+            ref_hum = REF_HUM_DEFAULT;
+        }
+    }
+
+    if(warm)
+    {
+        //the reference humidity might not have been saved yet
+        ref_hum = w.ref_hum;
+        hum = w.hum;
+        ambient_temp = w.ambient_temp;
+        state = (enum statev)w.state;
+    }
+    else
+    {
+        //Sane defaults until the first dht_update(), the sensor needs some
+        //time after power up anyway
+        hum = ref_hum*10;
+        ambient_temp = 21*10;
+    }
+
+    //periodic work, called from timer_dispatch() at the periods of param.h
+    hum_task = task_add(PSTR("hum"), &hum_loop, &hum_loop_delay);
+    task_add(PSTR("coil"), &coil_loop, &coil_loop_delay);
+    disp_task = task_add(PSTR("disp"), &display, &disp_delay);
+    task_add(PSTR("save"), &ref_hum_save, &save_delay);
+    task_add(PSTR("dht"), &dht_update, &hum_read_delay);
+    task_add(PSTR("telemetry"), &telemetry_update, &telemetry_delay);
+    task_schedule();
+
+    //everything is set up, globally enable interrupts
+    sei();
+
+    //go on with the readings from before a warm reset right away, and show
+    //the reference humidity
+    control();
+}
+
+int main(void)
+{
+    uint8_t ev;
+
+    init();
+
+    while(1)
+    {
+        //sleep until something happens
+        ev = event_wait();
+
+        if(ev & EV_TIMER)
+        {
+            timer_dispatch();
+            //a dht reading might have finished
+            dht_fetch();
+        }
+        if(ev & EV_KEY)
+        {
+            io_switch_handler();
+        }
+        //also sends replies that had to wait for the TX buffer
+        shell_poll();
+
+        if(ev & (EV_KEY | EV_SENSOR))
+        {
+            //don't wait for the next pass to react
+            control();
+        }
+        if(state == off)
+        {
+            standby();
+        }
+    }
+}
@@ -0,0 +1,243 @@
+#include "common.h"
+#include <string.h>
+#include <avr/pgmspace.h>
+#include "param.h"
+#include "settings.h"
+
+uint8_t ref_tdiff_l = REF_TDIFF_L;
+uint8_t ref_tdiff_h = REF_TDIFF_H;
+uint16_t hum_loop_delay = HUM_LOOP_DELAY;
+uint16_t hum_read_delay = HUM_READ_DELAY;
+uint16_t coil_loop_delay = COIL_LOOP_DELAY;
+uint16_t save_delay = SAVE_DELAY;
+uint16_t disp_delay = DISP_DELAY;
+uint16_t telemetry_delay = TELEMETRY_DELAY;
+
+/*The parameters are saved one after the other in this order, so only ever
+ *append new ones. The size of each is the size of its variable.
+ *The delays are limited by the longest timer interval (TIMER_IDLE_TICKS).
+ *hum_loop_delay was called main_loop_delay before, it's the same value.
+ */
+#define PARAM_TABLE(f) \
+    f("ref_hum",         ref_hum,           0,    99,    REF_HUM_DEFAULT) \
+    f("ref_hum_var",     ref_hum_var,       1,    20,    REF_HUM_VAR) \
+    f("ref_tdiff_l",     ref_tdiff_l,       1,    30,    REF_TDIFF_L) \
+    f("ref_tdiff_h",     ref_tdiff_h,       1,    30,    REF_TDIFF_H) \
+    f("hum_loop_delay",  hum_loop_delay,    100,  16000, HUM_LOOP_DELAY) \
+    f("hum_read_delay",  hum_read_delay,    2000, 16000, HUM_READ_DELAY) \
+    f("coil_loop_delay", coil_loop_delay,   20,   16000, COIL_LOOP_DELAY) \
+    f("save_delay",      save_delay,        1000, 16000, SAVE_DELAY) \
+    f("disp_delay",      disp_delay,        50,   16000, DISP_DELAY) \
+    f("telemetry_delay", telemetry_delay,   100,  16000, TELEMETRY_DELAY)
+
+#define PARAM_ENTRY(name, var, min, max, def) \
+    {name, &var, sizeof(var), min, max, def},
+#define PARAM_SIZE(name, var, min, max, def)    + sizeof(var)
+#define PARAM_SIZE_OK(name, var, min, max, def) \
+    (sizeof(var) == 1 || sizeof(var) == 2) &&
+
+static const param params[] PROGMEM = {
+    PARAM_TABLE(PARAM_ENTRY)
+};
+
+static_assert(PARAM_TABLE(PARAM_SIZE_OK) 1,
+               "parameters have to be 1 or 2 bytes");
+static_assert(0 PARAM_TABLE(PARAM_SIZE) <= SETTINGS_DATA_SIZE,
+               "parameters don't fit into the saved settings");
+#define PARAM_COUNT (sizeof(params)/sizeof(params[0]))
+
+static uint8_t image[SETTINGS_DATA_SIZE];   //parameters as last saved
+static void (*changed_hook)(void);
+
+static uint8_t param_consistent(void)
+/*Checks of parameters that depend on each other
+ */
+{
+    return ref_tdiff_l <= ref_tdiff_h;
+}
+
+static void param_entry(uint8_t idx, param* p)
+{
+    memcpy_P(p, &params[idx], sizeof(param));
+}
+
+static uint8_t param_offset(uint8_t idx)
+/*Position of the parameter in the saved settings
+ */
+{
+    uint8_t i;
+    uint8_t offset = 0;
+
+    for(i = 0; i < idx; i++)
+    {
+        offset += pgm_read_byte(&params[i].size);
+    }
+    return offset;
+}
+
+static uint16_t param_read(const param* p)
+{
+    return p->size == 1 ? *(uint8_t*)p->value : *(uint16_t*)p->value;
+}
+
+static void param_write(const param* p, uint16_t value)
+{
+    if(p->size == 1)
+    {
+        *(uint8_t*)p->value = value;
+    }
+    else
+    {
+        *(uint16_t*)p->value = value;
+    }
+}
+
+int8_t param_init(void (*changed)(void))
+/*Load the saved parameters, those which are out of range get their default.
+ *$changed is called whenever param_set() changed a parameter.
+ *Returns -1 if nothing was saved yet.
+ */
+{
+    param p;
+    uint8_t i;
+    uint8_t offset = 0;
+    uint16_t value;
+    int8_t ret;
+
+    changed_hook = changed;
+    ret = settings_load(image, sizeof(image));
+
+    for(i = 0; i < PARAM_COUNT; i++)
+    {
+        param_entry(i, &p);
+        value = 0;
+        memcpy(&value, &image[offset], p.size);
+        offset += p.size;
+        if(ret != 0 || value < p.min || value > p.max)
+        {
+            value = p.def;
+        }
+        param_write(&p, value);
+    }
+    if(!param_consistent())
+    {
+        ref_tdiff_l = REF_TDIFF_L;
+        ref_tdiff_h = REF_TDIFF_H;
+    }
+    return ret;
+}
+
+uint8_t param_count(void)
+{
+    return PARAM_COUNT;
+}
+
+int8_t param_find(const char* name)
+/*Index of the parameter called $name, -1 if there's none
+ */
+{
+    uint8_t i;
+
+    for(i = 0; i < PARAM_COUNT; i++)
+    {
+        if(strcmp_P(name, params[i].name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* param_name(uint8_t idx, char* buf)
+/*Copy the name into $buf (PARAM_NAME_LEN bytes)
+ */
+{
+    return strcpy_P(buf, params[idx].name);
+}
+
+uint16_t param_get(uint8_t idx)
+{
+    param p;
+
+    param_entry(idx, &p);
+    return param_read(&p);
+}
+
+int8_t param_set(uint8_t idx, uint16_t value)
+/*Returns -1 if $value is out of range, or doesn't fit the other parameters
+ *(ref_tdiff_l above ref_tdiff_h). Takes effect right away, but isn't saved
+ *until param_save().
+ */
+{
+    param p;
+    uint16_t old;
+
+    param_entry(idx, &p);
+    if(value < p.min || value > p.max)
+    {
+        return -1;
+    }
+    old = param_read(&p);
+    param_write(&p, value);
+    if(!param_consistent())
+    {
+        param_write(&p, old);
+        return -1;
+    }
+    if(changed_hook)
+    {
+        changed_hook();
+    }
+    return 0;
+}
+
+static int8_t param_store(int8_t only)
+/*Update one ($only >= 0) or all parameters in the image and save it
+ */
+{
+    param p;
+    uint8_t i;
+    uint16_t value;
+
+    if(settings_busy())
+    {
+        return -1;
+    }
+    for(i = 0; i < PARAM_COUNT; i++)
+    {
+        if(only < 0 || only == i)
+        {
+            param_entry(i, &p);
+            value = param_read(&p);
+            memcpy(&image[param_offset(i)], &value, p.size);
+        }
+    }
+    return settings_save(image, sizeof(image));
+}
+
+int8_t param_save(void)
+/*Save all parameters. Returns -1 if the EEPROM is still busy.
+ */
+{
+    return param_store(-1);
+}
+
+int8_t param_save_value(const void* value)
+/*Save only the parameter held by the variable at $value, all others keep
+ *their saved values (e.g. to save the reference humidity set with the keys
+ *without saving parameters someone is trying out over the UART).
+ */
+{
+    param p;
+    uint8_t i;
+
+    for(i = 0; i < PARAM_COUNT; i++)
+    {
+        param_entry(i, &p);
+        if(p.value == value)
+        {
+            return param_store(i);
+        }
+    }
+    return -1;
+}
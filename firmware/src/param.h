@@ -0,0 +1,59 @@
+#ifndef PARAM_H
+#define PARAM_H
+
+/*Tunable parameters. Each one has a name, a valid range and a default in a
+ *table in flash, so they can be read and changed over the UART (see shell.cpp)
+ *and are saved together with the reference humidity.
+ */
+
+//defaults, used if nothing valid was saved yet
+#define REF_HUM_DEFAULT 50
+#define REF_HUM_VAR     3   //stop drying at ref_hum-3
+//keep cooling unit between these two values (C) below ambient temperature
+#define REF_TDIFF_L     7
+#define REF_TDIFF_H     9
+//period of the humidity loop, which switches drying on and off. It also runs
+//right away on key and sensor events
+#define HUM_LOOP_DELAY  1000        //ms
+//period of the coil loop, which switches the compressor while drying
+#define COIL_LOOP_DELAY 100         //ms
+//read from humidity (and ambient temperature) sensor only every 10 seconds
+#define HUM_READ_DELAY  10*1000U    //ms
+//save the reference humidity this often, if it was changed
+#define SAVE_DELAY      5*1000U     //ms
+//bring the LEDs and the display up to date this often
+#define DISP_DELAY      200         //ms
+//send a telemetry frame (see telemetry.h) this often
+#define TELEMETRY_DELAY 2000        //ms
+
+//longest parameter name including the terminating 0
+#define PARAM_NAME_LEN  16
+
+typedef struct Param{
+    char name[PARAM_NAME_LEN];
+    void* value;    //variable holding the parameter
+    uint8_t size;   //of the variable, 1 or 2 bytes
+    uint16_t min;
+    uint16_t max;
+    uint16_t def;
+} param;
+
+extern uint8_t ref_tdiff_l;
+extern uint8_t ref_tdiff_h;
+extern uint16_t hum_loop_delay;
+extern uint16_t hum_read_delay;
+extern uint16_t coil_loop_delay;
+extern uint16_t save_delay;
+extern uint16_t disp_delay;
+extern uint16_t telemetry_delay;
+
+int8_t param_init(void (*changed)(void));
+uint8_t param_count(void);
+int8_t param_find(const char* name);
+const char* param_name(uint8_t idx, char* buf);
+uint16_t param_get(uint8_t idx);
+int8_t param_set(uint8_t idx, uint16_t value);
+int8_t param_save(void);
+int8_t param_save_value(const void* value);
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef PINS_H
+#define PINS_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+/*Every pin the firmware uses, as Pin<port, bit>. This is the only place pins
+ *are assigned, everything else uses the static members of the Pin types
+ *below, e.g. PIN_FAN::high(). They're inlined to the same bit operations on
+ *the port registers as setbit() and friends, a constant address and mask
+ *that avr-g++ turns into sbi/cbi/sbic/sbis (see make disasm).
+ */
+
+enum pin_port {port_b, port_c, port_d};
+
+//registers of a port
+template<pin_port P> struct Port;
+#define PORT_REGS(p, out_, dir_, in_)                                       \
+    template<> struct Port<p>{                                              \
+        static inline volatile uint8_t& out(void) __attribute__((always_inline)) \
+        { return(out_); }                                                   \
+        static inline volatile uint8_t& dir(void) __attribute__((always_inline)) \
+        { return(dir_); }                                                   \
+        static inline uint8_t in(void) __attribute__((always_inline))       \
+        { return(in_); }                                                    \
+    };
+PORT_REGS(port_b, PORTB, DDRB, PINB)
+PORT_REGS(port_c, PORTC, DDRC, PINC)
+PORT_REGS(port_d, PORTD, DDRD, PIND)
+#undef PORT_REGS
+
+/*Pin $B of port $P. A pin the ATmega8 doesn't have is a compile error as
+ *soon as the type is used.
+ */
+template<pin_port P, uint8_t B> struct Pin{
+    //PC6 is RESET
+    static_assert(B < 8 && (P != port_c || B < 6),
+                  "pin doesn't exist on the ATmega8");
+
+    static const pin_port port = P;
+    //bit number and mask within the port
+    static const uint8_t num = B;
+    static const uint8_t bit = 1<<B;
+
+    //output level
+    static inline void high(void) __attribute__((always_inline))
+    { Port<P>::out() |= bit; }
+    static inline void low(void) __attribute__((always_inline))
+    { Port<P>::out() &= (uint8_t)~bit; }
+    static inline void toggle(void) __attribute__((always_inline))
+    { Port<P>::out() ^= bit; }
+    //direction
+    static inline void output(void) __attribute__((always_inline))
+    { Port<P>::dir() |= bit; }
+    static inline void input(void) __attribute__((always_inline))
+    { Port<P>::dir() &= (uint8_t)~bit; }
+    //level on the pin, 1 or 0
+    static inline uint8_t read(void) __attribute__((always_inline))
+    { return((Port<P>::in() >> B) & 1); }
+    //output level (or pull-up) set, 1 or 0
+    static inline uint8_t state(void) __attribute__((always_inline))
+    { return((Port<P>::out() >> B) & 1); }
+    //1 if configured as output
+    static inline uint8_t is_output(void) __attribute__((always_inline))
+    { return((Port<P>::dir() >> B) & 1); }
+};
+
+/*Pins that belong to a peripheral. They check that the pin is one the
+ *peripheral can use, otherwise they're the plain pin.
+ */
+//ADC input, $channel for ADMUX
+template<class pin> struct AdcInput : pin{
+    static_assert(pin::port == port_c, "not an ADC input (PC0-PC5)");
+    static const uint8_t channel = pin::num;
+};
+//input capture of timer1, TIMER1_CAPT_vect
+template<class pin> struct CaptureInput : pin{
+    static_assert(pin::port == port_b && pin::num == 0, "ICP1 is PB0");
+};
+//USART receive and transmit
+template<class pin> struct UsartRxd : pin{
+    static_assert(pin::port == port_d && pin::num == 0, "RXD is PD0");
+};
+template<class pin> struct UsartTxd : pin{
+    static_assert(pin::port == port_d && pin::num == 1, "TXD is PD1");
+};
+
+//fan and compressor relays
+typedef Pin<port_c, 0>                  PIN_FAN;
+typedef Pin<port_d, 4>                  PIN_COMP;
+//cooling unit temperature sensor
+typedef AdcInput<Pin<port_c, 1> >       PIN_CTS;
+//water full sensor
+typedef CaptureInput<Pin<port_b, 0> >   PIN_FULL;
+//DHT22 data line
+typedef Pin<port_b, 2>                  PIN_DHT;
+//IO panel: shift register clock and data, switches, and the transistors
+//switching the LEDs and the two 7 segment displays
+typedef Pin<port_d, 2>                  PIN_IOCLK;
+typedef Pin<port_c, 5>                  PIN_IODAT;
+typedef Pin<port_c, 4>                  PIN_IOKEY;
+typedef Pin<port_d, 7>                  PIN_IOLED;
+typedef Pin<port_b, 6>                  PIN_IODIS0;
+typedef Pin<port_b, 7>                  PIN_IODIS1;
+//IC4.SCL on the IO panel, not used yet
+typedef Pin<port_d, 3>                  PIN_IOSCL;
+//USART, only listed so nothing else ends up there
+typedef UsartRxd<Pin<port_d, 0> >       PIN_RXD;
+typedef UsartTxd<Pin<port_d, 1> >       PIN_TXD;
+
+/*Checks of the pin map at compile time. Going through the list also
+ *instantiates every pin, with the checks above.
+ */
+template<class... pins> struct PinMap;
+template<> struct PinMap<>{
+    static constexpr uint8_t mask(pin_port) { return(0); }
+    static constexpr bool unique(pin_port) { return(true); }
+};
+template<class pin, class... rest> struct PinMap<pin, rest...>{
+    //bits of the pins on $port
+    static constexpr uint8_t mask(pin_port port)
+    {
+        return((pin::port == port ? pin::bit : 0) | PinMap<rest...>::mask(port));
+    }
+    //no two pins on the same bit of $port
+    static constexpr bool unique(pin_port port)
+    {
+        return(!(pin::port == port && (PinMap<rest...>::mask(port) & pin::bit))
+               && PinMap<rest...>::unique(port));
+    }
+};
+typedef PinMap<PIN_FAN, PIN_COMP, PIN_CTS, PIN_FULL, PIN_DHT, PIN_IOCLK,
+               PIN_IODAT, PIN_IOKEY, PIN_IOLED, PIN_IODIS0, PIN_IODIS1,
+               PIN_IOSCL, PIN_RXD, PIN_TXD> pin_map;
+
+static_assert(pin_map::unique(port_b), "two pins on the same bit of port B");
+static_assert(pin_map::unique(port_c), "two pins on the same bit of port C");
+static_assert(pin_map::unique(port_d), "two pins on the same bit of port D");
+
+#endif
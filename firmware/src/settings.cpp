@@ -0,0 +1,133 @@
+#include "common.h"
+#include <stddef.h>
+#include <string.h>
+#include <avr/eeprom.h>
+#include <util/crc16.h>
+#include "settings.h"
+
+static settings_record current;     //copy of the newest record
+static uint8_t current_slot;
+static uint8_t current_valid;       //0 if there's no valid record at all
+
+//Record being written by the EEPROM ready interrupt
+static settings_record job;
+static uint16_t job_addr;
+static volatile uint8_t job_pos;    //next byte to write, SETTINGS_RECORD_SIZE
+                                    //if there's nothing to do
+
+static uint16_t record_crc(const settings_record* r)
+{
+    const uint8_t* p = (const uint8_t*)r;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for(i = 0; i < offsetof(settings_record, crc); i++)
+    {
+        crc = _crc_ccitt_update(crc, p[i]);
+    }
+    return crc;
+}
+
+void settings_init(void)
+/*Find the newest valid record. Starts over when called again, a save that
+ *wasn't finished is given up.
+ */
+{
+    settings_record r;
+    uint8_t slot;
+
+    job_pos = SETTINGS_RECORD_SIZE;
+    current_valid = 0;
+
+    for(slot = 0; slot < SETTINGS_SLOTS; slot++)
+    {
+        eeprom_read_block(&r, (const void*)(size_t)(slot*SETTINGS_RECORD_SIZE),
+                          SETTINGS_RECORD_SIZE);
+        if(r.crc != record_crc(&r))
+        {
+            continue;
+        }
+        //the sequence number wraps around, compare the difference
+        if(!current_valid || (int16_t)(r.seq - current.seq) > 0)
+        {
+            current = r;
+            current_slot = slot;
+            current_valid = 1;
+        }
+    }
+}
+
+int8_t settings_load(void* data, uint8_t len)
+/*Copy $len bytes of the newest saved settings to $data.
+ *Returns -1 if nothing was saved yet.
+ */
+{
+    if(!current_valid || len > SETTINGS_DATA_SIZE)
+    {
+        return -1;
+    }
+    memcpy(data, current.data, len);
+    return 0;
+}
+
+int8_t settings_save(const void* data, uint8_t len)
+/*Save $len bytes from $data as new settings, unless they didn't change.
+ *Doesn't wait for the EEPROM, the record is written byte by byte from the
+ *EEPROM ready interrupt.
+ *Returns -1 if the previous save isn't finished yet (try again later).
+ */
+{
+    if(len > SETTINGS_DATA_SIZE || settings_busy())
+    {
+        return -1;
+    }
+    if(current_valid && memcmp(current.data, data, len) == 0)
+    {
+        return 0;
+    }
+
+    memset(&job, 0, sizeof(job));
+    memcpy(job.data, data, len);
+    job.seq = current.seq + 1;
+    job.crc = record_crc(&job);
+
+    current_slot = current_valid ? (current_slot + 1) % SETTINGS_SLOTS : 0;
+    current = job;
+    current_valid = 1;
+
+    job_addr = current_slot * SETTINGS_RECORD_SIZE;
+    job_pos = 0;
+    setbit(EECR, EERIE);
+    return 0;
+}
+
+uint8_t settings_busy(void)
+{
+    return job_pos < SETTINGS_RECORD_SIZE;
+}
+
+ISR(EE_RDY_vect)
+/*Called whenever the EEPROM is ready for the next write. Bytes which already
+ *have the right value are skipped, the crc is written last.
+ */
+{
+    uint8_t b;
+
+    while(job_pos < SETTINGS_RECORD_SIZE)
+    {
+        b = ((uint8_t*)&job)[job_pos];
+        EEAR = job_addr + job_pos;
+        job_pos++;
+        setbit(EECR, EERE);
+        if(EEDR != b)
+        {
+            EEDR = b;
+            //EEWE has to follow EEMWE within 4 cycles (interrupts are off)
+            setbit(EECR, EEMWE);
+            setbit(EECR, EEWE);
+            return;
+        }
+    }
+    //all done
+    clearbit(EECR, EERIE);
+}
@@ -0,0 +1,26 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+/*Settings that survive a reboot. They are stored as a log of records spread
+ *over the whole EEPROM, every save goes to the slot after the newest record.
+ *So every cell is written only once per SETTINGS_SLOTS saves, and a save
+ *interrupted by a power loss leaves the previous record intact.
+ */
+
+#define SETTINGS_RECORD_SIZE    24
+//bytes of settings data per record (record minus sequence number and crc)
+#define SETTINGS_DATA_SIZE      (SETTINGS_RECORD_SIZE-4)
+#define SETTINGS_SLOTS          ((E2END+1)/SETTINGS_RECORD_SIZE)
+
+typedef struct SettingsRecord{
+    uint16_t seq;   //incremented with every save, the highest one is newest
+    uint8_t data[SETTINGS_DATA_SIZE];
+    uint16_t crc;   //crc-ccitt of all other bytes
+} settings_record;
+
+void settings_init(void);
+int8_t settings_load(void* data, uint8_t len);
+int8_t settings_save(const void* data, uint8_t len);
+uint8_t settings_busy(void);
+
+#endif
@@ -0,0 +1,350 @@
+#include "common.h"
+#include <string.h>
+#include <avr/pgmspace.h>
+#include "param.h"
+#include "shell.h"
+#include "uart.h"
+#include "fmt.h"
+#include "task.h"
+
+/*Nothing in here waits: received bytes are collected until a line is
+ *complete, and executed as soon as there's room in the reply queue. A reply
+ *line is only sent once SHELL_REPLY_MAX bytes fit into the TX buffer. Input
+ *is read on meanwhile, so the RX buffer only fills up while a complete line
+ *waits for the queue. Whatever the UART drops then is answered with one
+ *"error: input lost" as soon as the bytes before the gap are read, also if
+ *nothing follows it. If the input went on right after the gap, the rest of
+ *that line is skipped, input that comes later is a new line anyway.
+ */
+
+static char line[SHELL_LINE_MAX];
+static uint8_t line_len;            //SHELL_LINE_MAX if the line is too long
+static uint8_t line_ready;          //complete, waiting to be executed
+static uint8_t line_lost;           //bytes of the line were dropped
+static uint8_t rx_overflows;        //uart_rx_overflows as last seen
+static uint8_t rx_resumed;          //uart_rx_resumed when it was seen
+static uint8_t rx_intact;           //bytes to read up to the dropped ones
+static uint8_t rx_gap;              //read up to the dropped bytes
+static uint8_t rx_after_gap;        //next byte is the first after the gap
+static uint8_t rx_garbled;          //dropped twice before we got there
+static uint8_t rx_skip;             //skip the rest of the line after a gap
+static shell_reply replies[SHELL_QUEUE];
+static uint8_t reply_first;
+static uint8_t reply_count;
+
+static shell_reply* shell_queue(void)
+/*Next free entry of the reply queue, the caller makes sure there is one
+ */
+{
+    return &replies[(reply_first + reply_count++) & (SHELL_QUEUE-1)];
+}
+
+static void shell_reply_P(const char* msg)
+{
+    shell_reply* r = shell_queue();
+
+    r->msg = msg;
+    r->list = SHELL_MSG;
+}
+
+static void shell_list(uint8_t list, uint8_t first, uint8_t end)
+/*Queue entries $first up to $end-1 of a list
+ */
+{
+    shell_reply* r = shell_queue();
+
+    r->list = list;
+    r->next = first;
+    r->end = end;
+}
+
+static void shell_print_param(uint8_t idx)
+{
+    char name[PARAM_NAME_LEN];
+
+    fmt_str(param_name(idx, name));
+    fmt_char('=');
+    fmt_uint(param_get(idx));
+    fmt_str_P(PSTR(FMT_NL));
+    fmt_char('\0');
+}
+
+static void shell_print_task(uint8_t id)
+/*name, period (ms), last and longest execution time (cpu cycles)
+ */
+{
+    const task* t = task_get(id);
+
+    fmt_str_P(t->name);
+    fmt_char(' ');
+    fmt_uint(*t->period);
+    fmt_char(' ');
+    fmt_uint(t->last);
+    fmt_char(' ');
+    fmt_uint(t->max);
+    fmt_str_P(PSTR(FMT_NL));
+    fmt_char('\0');
+}
+
+static int8_t shell_number(const char* s, uint16_t* value)
+{
+    char* end;
+    unsigned long n;
+
+    if(s == NULL)
+    {
+        return -1;
+    }
+    n = strtoul(s, &end, 10);
+    if(*end != '\0' || end == s || n > 0xFFFF)
+    {
+        return -1;
+    }
+    *value = n;
+    return 0;
+}
+
+static void shell_execute(void)
+{
+    char* cmd;
+    char* name;
+    char* arg;
+    char* extra;
+    int8_t idx = -1;
+    uint16_t value;
+
+    cmd = strtok(line, " ");
+    name = strtok(NULL, " ");
+    arg = strtok(NULL, " ");
+    extra = strtok(NULL, " ");
+
+    if(cmd == NULL)
+    {
+        //empty line, e.g. the \n of \r\n
+        return;
+    }
+    if(name != NULL)
+    {
+        idx = param_find(name);
+    }
+
+    if(strcmp_P(cmd, PSTR("get")) == 0 && arg == NULL)
+    {
+        if(name == NULL)
+        {
+            shell_list(SHELL_PARAMS, 0, param_count());
+        }
+        else if(idx >= 0)
+        {
+            shell_list(SHELL_PARAMS, idx, idx + 1);
+        }
+        else
+        {
+            shell_reply_P(PSTR("error: unknown parameter" FMT_NL));
+        }
+    }
+    else if(strcmp_P(cmd, PSTR("set")) == 0 && extra == NULL)
+    {
+        if(idx < 0)
+        {
+            shell_reply_P(PSTR("error: unknown parameter" FMT_NL));
+        }
+        else if(shell_number(arg, &value) != 0 || param_set(idx, value) != 0)
+        {
+            shell_reply_P(PSTR("error: invalid value" FMT_NL));
+        }
+        else
+        {
+            shell_reply_P(PSTR("ok" FMT_NL));
+        }
+    }
+    else if(strcmp_P(cmd, PSTR("save")) == 0 && name == NULL)
+    {
+        if(param_save() != 0)
+        {
+            shell_reply_P(PSTR("busy" FMT_NL));
+        }
+        else
+        {
+            shell_reply_P(PSTR("ok" FMT_NL));
+        }
+    }
+    else if(strcmp_P(cmd, PSTR("tasks")) == 0 && name == NULL)
+    {
+        shell_list(SHELL_TASKS, 0, task_count());
+    }
+    else
+    {
+        shell_reply_P(PSTR("error: unknown command" FMT_NL));
+    }
+}
+
+static void shell_line(void)
+/*Execute the complete line, needs a free entry in the reply queue
+ */
+{
+    if(line_lost)
+    {
+        shell_reply_P(PSTR("error: input lost" FMT_NL));
+    }
+    else if(line_len == SHELL_LINE_MAX)
+    {
+        shell_reply_P(PSTR("error: line too long" FMT_NL));
+    }
+    else
+    {
+        line[line_len] = '\0';
+        shell_execute();
+    }
+    line_len = 0;
+    line_lost = 0;
+    line_ready = 0;
+}
+
+static void shell_char(char c)
+{
+    if(c == '\r' || c == '\n')
+    {
+        if(line_len != 0 || line_lost)
+        {
+            line_ready = 1;
+        }
+    }
+    else if(c == '\b' || c == 0x7F)
+    {
+        if(line_len > 0 && line_len < SHELL_LINE_MAX)
+        {
+            line_len--;
+        }
+    }
+    else if(line_len < SHELL_LINE_MAX-1)
+    {
+        line[line_len++] = c;
+    }
+    else
+    {
+        //ignore the rest of the line
+        line_len = SHELL_LINE_MAX;
+    }
+}
+
+static void shell_read(void)
+/*Collect received bytes until a line is complete. Bytes the UART had to
+ *drop make the line they were part of invalid, so fragments of two lines
+ *are never executed as one.
+ */
+{
+    int16_t c;
+
+    while(!line_ready)
+    {
+        if(rx_gap)
+        {
+            //the line the dropped bytes belonged to is reported right away
+            rx_gap = 0;
+            rx_after_gap = 1;
+            line_lost = 1;
+            line_ready = 1;
+            return;
+        }
+        if(uart_rx_overflows != rx_overflows)
+        {
+            //the RX buffer is full, the bytes were dropped after the ones
+            //in it. If there was an earlier gap yet to come, discard
+            //everything up to this one. Whether input follows the new gap
+            //right away is only known once it does, uart_rx_resumed
+            //doesn't count it yet.
+            rx_overflows = uart_rx_overflows;
+            if(!rx_after_gap)
+            {
+                rx_resumed = uart_rx_resumed;
+            }
+            rx_garbled = rx_intact != 0;
+            rx_intact = UART_RX_SIZE-1;
+        }
+        c = uart_tryread();
+        if(c < 0)
+        {
+            return;
+        }
+        if(rx_after_gap)
+        {
+            //the rest of the lost line, or the start of new input. A gap
+            //that's still ahead can't have been resumed yet.
+            rx_after_gap = 0;
+            rx_skip = uart_rx_resumed != rx_resumed;
+            rx_resumed = uart_rx_resumed;
+        }
+        if(rx_intact != 0 && --rx_intact == 0)
+        {
+            //last byte before the gap
+            rx_gap = 1;
+        }
+        if(rx_skip || rx_garbled)
+        {
+            line_len = 0;
+            if(c == '\r' || c == '\n')
+            {
+                rx_skip = 0;
+            }
+            if(rx_intact == 0)
+            {
+                rx_garbled = 0;
+            }
+            continue;
+        }
+        shell_char(c);
+    }
+}
+
+static void shell_send(void)
+/*Send queued replies, a line at a time while it fits into the TX buffer
+ */
+{
+    shell_reply* r;
+
+    while(reply_count != 0 && uart_txfree() >= SHELL_REPLY_MAX)
+    {
+        r = &replies[reply_first];
+        if(r->list == SHELL_MSG)
+        {
+            fmt_str_P(r->msg);
+            fmt_char('\0');
+            r->next = r->end;
+        }
+        else if(r->next < r->end)
+        {
+            if(r->list == SHELL_TASKS)
+            {
+                shell_print_task(r->next++);
+            }
+            else
+            {
+                shell_print_param(r->next++);
+            }
+        }
+        if(r->list == SHELL_MSG || r->next >= r->end)
+        {
+            reply_first = (reply_first + 1) & (SHELL_QUEUE-1);
+            reply_count--;
+        }
+    }
+}
+
+void shell_poll(void)
+/*Process received input and send pending replies, as far as possible without
+ *waiting. Call from the main loop on EV_UART, and regularly while a reply
+ *might be waiting for the TX buffer.
+ */
+{
+    while(1)
+    {
+        shell_send();
+        shell_read();
+        if(!line_ready || reply_count == SHELL_QUEUE)
+        {
+            return;
+        }
+        shell_line();
+    }
+}
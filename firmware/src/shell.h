@@ -0,0 +1,41 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+/*Line based command shell on the UART, to read and change the parameters of
+ *param.h without reflashing:
+ *  get             list all parameters as name=value
+ *  get <name>      show one parameter
+ *  set <name> <n>  change a parameter, effective immediately
+ *  save            save all parameters to the EEPROM
+ *  tasks           list the tasks of task.h as name, period in ms, last and
+ *                  longest execution time in cpu cycles
+ *Every reply line ends with a 0 byte, so the telemetry decoder (which shares
+ *the UART) can tell replies and frames apart. Input isn't echoed, use the
+ *local echo of your terminal.
+ */
+
+//longest command line, longer ones are answered with an error
+#define SHELL_LINE_MAX  32
+//longest reply line including the line end and the 0 byte, has to fit
+//name=value of the longest parameter name, the task lines and all error
+//messages
+#define SHELL_REPLY_MAX 32
+//replies waiting for the TX buffer, has to be a power of two. Commands are
+//executed right away as long as there's room for their reply.
+#define SHELL_QUEUE     4
+
+//what a reply is
+#define SHELL_MSG       0   //message in flash
+#define SHELL_PARAMS    1   //parameters as name=value
+#define SHELL_TASKS     2   //tasks, see task.h
+
+typedef struct ShellReply{
+    const char* msg;        //SHELL_MSG
+    uint8_t list;           //SHELL_* above
+    uint8_t next;           //lists: entries next up to end-1 are still to
+    uint8_t end;            //be sent
+} shell_reply;
+
+void shell_poll(void);
+
+#endif
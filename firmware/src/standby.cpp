@@ -0,0 +1,40 @@
+#include "common.h"
+#include <avr/sleep.h>
+#include "standby.h"
+#include "timer.h"
+#include "adc.h"
+#include "io.h"
+#include "event.h"
+
+ISR(TIMER2_COMP_vect)
+{
+    event_post(EV_WAKE);
+}
+
+void standby_enter(void)
+/*Stop everything not needed to wait for the ON/OFF key. From here on,
+ *event_wait() returns EV_WAKE every STANDBY_WAKE.
+ */
+{
+    timer_suspend();
+    adc_suspend();
+    io_suspend();
+
+    //timer2 in CTC mode, clk/1024
+    OCR2 = STANDBY_OCR;
+    TCCR2 = (0<<WGM20) | (1<<WGM21) | (1<<CS22) | (1<<CS21) | (1<<CS20);
+    TIFR = (1<<OCF2);
+    setbit(TIMSK, OCIE2);
+}
+
+void standby_leave(void)
+/*Pick up where standby_enter() stopped
+ */
+{
+    clearbit(TIMSK, OCIE2);
+    TCCR2 = 0;
+
+    io_resume();
+    adc_resume();
+    timer_resume();
+}
@@ -0,0 +1,26 @@
+#ifndef STANDBY_H
+#define STANDBY_H
+
+/*Standby while the unit is switched off. Timer1 (and with it the display
+ *multiplexing and all registered timers), the ADC and the panel are
+ *stopped, the cpu sleeps in idle mode and timer2 wakes it up every
+ *STANDBY_WAKE with EV_WAKE to look at the keys.
+ *Power-save mode would keep timer2 running only if it was clocked from a
+ *watch crystal, but TOSC1/TOSC2 (PB6/PB7) switch the displays here. The
+ *UART keeps working, so does the water full interrupt.
+ */
+
+//timer2 wakes the cpu up this often
+#define STANDBY_WAKE        50  //ms
+//timer2 runs from F_CPU/1024 and clears at the compare match
+#define STANDBY_OCR         ((STANDBY_WAKE)*(F_CPU/1000UL)/1024 - 1)
+#if STANDBY_OCR > 255 || STANDBY_OCR < 1
+#error "STANDBY_WAKE doesn't fit timer2"
+#endif
+//ON/OFF has to read pressed this many wake ups in a row
+#define STANDBY_PRESSED     2
+
+void standby_enter(void);
+void standby_leave(void);
+
+#endif
@@ -0,0 +1,114 @@
+#include "common.h"
+#include <avr/pgmspace.h>
+#include "task.h"
+#include "timer.h"
+
+static task tasks[TASK_MAX];
+static uint8_t count;
+
+/*Timer functions don't get an argument, so every task slot has its own
+ *function calling task_run() with the slot
+ */
+#define TASK_STUB(n) static void task_run##n(void) { task_run(n); }
+TASK_STUB(0)
+TASK_STUB(1)
+TASK_STUB(2)
+TASK_STUB(3)
+TASK_STUB(4)
+TASK_STUB(5)
+#if TASK_MAX != 6
+#error "add or remove TASK_STUB()s and stubs[] entries to match TASK_MAX"
+#endif
+
+static void (* const stubs[TASK_MAX])(void) = {
+    &task_run0, &task_run1, &task_run2, &task_run3, &task_run4, &task_run5,
+};
+
+int8_t task_add(const char* name, void (*func)(void), const uint16_t* period)
+/*Add a task calling $func every *$period milliseconds. $name (in flash) is
+ *what it's listed as. Its timer is registered by the next task_schedule().
+ *Returns the id of the task, -1 if all TASK_MAX are in use.
+ */
+{
+    task* t;
+
+    if(count == TASK_MAX)
+    {
+        return -1;
+    }
+    t = &tasks[count];
+    t->name = name;
+    t->func = func;
+    t->period = period;
+    t->timer = -1;
+    return count++;
+}
+
+void task_schedule(void)
+/*(Re)register the timers of all tasks whose periods changed, e.g. after a
+ *parameter was set. A task whose timer can't be registered is tried again
+ *next time.
+ */
+{
+    uint8_t id;
+    task* t;
+
+    for(id = 0; id < count; id++)
+    {
+        t = &tasks[id];
+        if(t->timer < 0 || *t->period != t->scheduled)
+        {
+            deregister_timer(t->timer);
+            t->timer = register_timer(stubs[id], TIMER_MS(*t->period),
+                                      TIMER_DEFERRED);
+            t->scheduled = *t->period;
+        }
+    }
+}
+
+void task_run(int8_t id)
+/*Run a task and take its time. Called by its timer, or directly to run it
+ *ahead of time, e.g. in reaction to an event. Don't call from an interrupt.
+ */
+{
+    task* t;
+    uint8_t start;
+    uint32_t begin;
+    uint16_t ticks;
+    uint16_t cycles;
+
+    if(id < 0 || id >= count)
+    {
+        return;
+    }
+    t = &tasks[id];
+
+    begin = timer_now();
+    start = TCNT0;
+    TCCR0 = TASK_CLOCK;
+    t->func();
+    TCCR0 = 0;
+    cycles = (uint8_t)(TCNT0 - start) * TASK_PRESCALER;
+    ticks = timer_now() - begin;
+
+    if(ticks >= TASK_LONG)
+    {
+        //timer0 might have wrapped around
+        cycles = ticks < 0xFFFF/TIMER_TICK ? ticks*TIMER_TICK : 0xFFFF;
+    }
+    t->last = cycles;
+    if(cycles > t->max)
+    {
+        t->max = cycles;
+    }
+}
+
+uint8_t task_count(void)
+{
+    return count;
+}
+
+const task* task_get(uint8_t id)
+{
+    return &tasks[id];
+}
@@ -0,0 +1,36 @@
+#ifndef TASK_H
+#define TASK_H
+
+/*Periodic work of the main loop, each piece with its own period. A task is
+ *a deferred timer whose period is read from a variable, usually a parameter
+ *of param.h, so it can be changed at runtime: task_schedule() registers the
+ *timers again for all periods that changed. Every run is timed, the
+ *execution times can be listed over the UART (see shell.h).
+ *Timer0 counts the cycles while a task runs and is stopped otherwise.
+ */
+
+//maximum number of tasks
+#define TASK_MAX        6
+//timer0 runs from F_CPU/64 while a task is timed
+#define TASK_CLOCK      ((0<<CS02) | (1<<CS01) | (1<<CS00))
+#define TASK_PRESCALER  64
+//runs of this many ticks or longer are timed in ticks, timer0 wraps after 16
+#define TASK_LONG       8
+
+typedef struct Task{
+    const char* name;           //in flash
+    void (*func)(void);
+    const uint16_t* period;     //ms
+    uint16_t scheduled;         //period the timer is registered with
+    int8_t timer;
+    uint16_t last;              //cpu cycles the last run took
+    uint16_t max;               //longest run so far, 0xFFFF is longer
+} task;
+
+int8_t task_add(const char* name, void (*func)(void), const uint16_t* period);
+void task_schedule(void);
+void task_run(int8_t id);
+uint8_t task_count(void);
+const task* task_get(uint8_t id);
+
+#endif
@@ -0,0 +1,91 @@
+#include "common.h"
+#include <util/crc16.h>
+#include "telemetry.h"
+#include "timer.h"
+#include "uart.h"
+
+#define PAYLOAD_SIZE    (1+1+4+2+2+2+1+1+1+2)
+//COBS adds one byte (for payloads < 254 bytes), plus the delimiter
+#define FRAME_SIZE      (PAYLOAD_SIZE+2)
+
+static uint8_t* put16(uint8_t* p, uint16_t v)
+{
+    *p++ = v;
+    *p++ = v >> 8;
+    return p;
+}
+
+static uint8_t cobs_encode(const uint8_t* in, uint8_t len, uint8_t* out)
+/*Consistent Overhead Byte Stuffing: replace every 0x00 by the distance to the
+ *next one, so 0x00 can delimit frames. Returns the encoded length.
+ */
+{
+    uint8_t code_pos = 0;   //where the distance of the current block goes
+    uint8_t code = 1;
+    uint8_t o = 1;
+    uint8_t i;
+
+    for(i = 0; i < len; i++)
+    {
+        if(in[i] == 0)
+        {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        }
+        else
+        {
+            out[o++] = in[i];
+            if(++code == 0xFF)
+            {
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+void telemetry_send(const telemetry* t)
+/*Send a frame, or drop it if it doesn't fit into the UART TX buffer.
+ *Half frames are never sent.
+ */
+{
+    static uint8_t seq;
+    uint8_t payload[PAYLOAD_SIZE];
+    uint8_t frame[FRAME_SIZE];
+    uint8_t* p = payload;
+    uint32_t now = timer_now();
+    uint16_t crc = 0xFFFF;
+    uint8_t len, i;
+
+    *p++ = TELEMETRY_VERSION;
+    *p++ = seq++;
+    p = put16(p, now);
+    p = put16(p, now >> 16);
+    p = put16(p, t->hum);
+    p = put16(p, t->ambient_temp);
+    p = put16(p, t->coil_temp);
+    *p++ = t->outputs;
+    *p++ = t->state;
+    *p++ = t->ref_hum;
+    for(i = 0; i < PAYLOAD_SIZE-2; i++)
+    {
+        crc = _crc_ccitt_update(crc, payload[i]);
+    }
+    put16(p, crc);
+
+    len = cobs_encode(payload, PAYLOAD_SIZE, frame);
+    frame[len++] = 0x00;
+
+    if(uart_txfree() < len)
+    {
+        return;
+    }
+    for(i = 0; i < len; i++)
+    {
+        uart_trywrite(frame[i]);
+    }
+}
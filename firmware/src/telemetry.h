@@ -0,0 +1,32 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+/*Binary measurement frames on the UART, decoded on the host by
+ *tools/telemetry_decode.py. A frame is the COBS encoded payload followed by a
+ *0x00 delimiter. Payload, all values little endian:
+ *  uint8   TELEMETRY_VERSION
+ *  uint8   sequence number, incremented with every frame
+ *  uint32  uptime in timer ticks (TIMER_TICK cpu cycles)
+ *  int16   humidity, tenths of a percent
+ *  int16   ambient temperature, tenths of a degree celsius
+ *  int16   cooling unit temperature, tenths of a degree celsius
+ *  uint8   outputs, OUT_* bits from control.h
+ *  uint8   state (enum statev)
+ *  uint8   reference humidity, percent
+ *  uint16  crc-ccitt (avr-libc _crc_ccitt_update, start 0xFFFF) of the above
+ */
+
+#define TELEMETRY_VERSION   1
+
+typedef struct Telemetry{
+    int16_t hum;
+    int16_t ambient_temp;
+    int16_t coil_temp;
+    uint8_t outputs;
+    uint8_t state;
+    uint8_t ref_hum;
+} telemetry;
+
+void telemetry_send(const telemetry* t);
+
+#endif
@@ -0,0 +1,426 @@
+#include "common.h"
+#include <util/atomic.h>
+#include "timer.h"
+#include "event.h"
+
+/*Registered timers live in a static table, the index is their id. Pending
+ *timers are hashed into a wheel by the tick they expire at, so processing a
+ *tick only means looking at the timers in the slot of that tick, no matter
+ *how many of them are registered.
+ *
+ *Timer1 runs freely with one counter step per tick, so TCNT1 holds the lower
+ *16 bits of the current tick. OCR1A is used as an alarm for the next tick we
+ *want to process: every tick in periodic mode, only the next deadline in
+ *tickless mode, TIMER_IDLE_TICKS ahead at most. The interrupt goes straight
+ *from the last processed tick to the current one, looking at each slot once
+ *at most.
+ */
+static timer timers[TIMER_MAX];
+static uint8_t wheel[TIMER_WHEEL_SLOTS];    //first timer id in every slot
+static uint32_t ticks;                      //last processed tick
+static uint32_t due_tick;                   //next tick a timer is due at,
+                                            //TIMER_IDLE_TICKS ahead at most
+static uint32_t uptime_base;                //timer_now() at tick 0
+//internal flag of one-shot timers that expired, but weren't called yet
+#define TIMER_EXPIRED   0x80
+
+//clock select of timer1, clk/1024
+#define TIMER_CLOCK     ((1<<CS12) | (0<<CS11) | (1<<CS10))
+
+static volatile uint16_t pending;           //one bit per expired deferred
+                                            //timer, see timer_dispatch()
+
+static void wheel_insert(uint8_t id)
+/*Put timer into the slot of the tick it expires at
+ */
+{
+    uint8_t slot = (uint8_t)timers[id].expires & (TIMER_WHEEL_SLOTS-1);
+
+    timers[id].next = wheel[slot];
+    wheel[slot] = id;
+    if(timers[id].expires - ticks < due_tick - ticks)
+    {
+        due_tick = timers[id].expires;
+    }
+}
+
+static void wheel_remove(uint8_t id)
+{
+    uint8_t* link = &wheel[(uint8_t)timers[id].expires & (TIMER_WHEEL_SLOTS-1)];
+
+    while(*link != TIMER_NONE)
+    {
+        if(*link == id)
+        {
+            *link = timers[id].next;
+            return;
+        }
+        link = &timers[*link].next;
+    }
+}
+
+static uint32_t hw_ticks(void)
+/*Extend the 16 bit counter value to the current 32 bit tick. This works as
+ *long as we process ticks at least every 0x8000 ticks, timer_program() never
+ *sets the alarm more than TIMER_IDLE_TICKS ahead. Call with interrupts
+ *disabled.
+ */
+{
+    return ticks + (uint16_t)(TCNT1 - (uint16_t)ticks);
+}
+
+#if TIMER_TICKLESS
+static void timer_next(void)
+/*Find the next tick a timer is due at, by looking through the slots of the
+ *following ticks. If nothing is due within a wheel turn, the earliest
+ *expiry in the timer table is taken instead, so empty wheel turns don't
+ *cost an interrupt. With no timer at all the alarm is TIMER_IDLE_TICKS
+ *ahead, to keep hw_ticks() right. Timers only become earlier by being
+ *registered, wheel_insert() takes care of that. A timer that was
+ *deregistered can only make the interrupt come for nothing.
+ */
+{
+    uint8_t i;
+    uint8_t id;
+
+    for(i = 1; i <= TIMER_WHEEL_SLOTS; i++)
+    {
+        id = wheel[(uint8_t)(ticks + i) & (TIMER_WHEEL_SLOTS-1)];
+        while(id != TIMER_NONE)
+        {
+            if(timers[id].expires == ticks + i)
+            {
+                due_tick = ticks + i;
+                return;
+            }
+            id = timers[id].next;
+        }
+    }
+    due_tick = ticks + TIMER_IDLE_TICKS;
+    for(id = 0; id < TIMER_MAX; id++)
+    {
+        //expired one-shot timers aren't in the wheel anymore
+        if(timers[id].interval != 0 && !(timers[id].flags & TIMER_EXPIRED)
+           && timers[id].expires - ticks < due_tick - ticks)
+        {
+            due_tick = timers[id].expires;
+        }
+    }
+}
+#endif
+
+static uint8_t timer_program(void)
+/*Set the compare match to the next tick we have to process. Returns 1 if the
+ *counter already ran past that tick, i.e. the match won't happen.
+ *Call with interrupts disabled.
+ */
+{
+    uint16_t alarm;
+
+#if TIMER_TICKLESS
+    alarm = (uint16_t)due_tick;
+#else
+    alarm = (uint16_t)ticks + 1;
+#endif
+    OCR1A = alarm;
+
+    return (int16_t)(TCNT1 - alarm) >= 0;
+}
+
+static void timer_reprogram(void)
+/*Same as timer_program(), for use outside of the interrupt routine: if we're
+ *already late, get the compare match as soon as possible so the interrupt
+ *can catch up.
+ */
+{
+    if(timer_program())
+    {
+        OCR1A = TCNT1 + 1;
+    }
+}
+
+void timer_init(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < TIMER_WHEEL_SLOTS; i++)
+    {
+        wheel[i] = TIMER_NONE;
+    }
+    due_tick = TIMER_IDLE_TICKS;
+
+    //We use timer1 in normal mode, the counter runs through all 16 bits
+    TCCR1B = (0<<WGM13) | (0<<WGM12);
+    TCCR1A = (0<<WGM11) | (0<<WGM10);
+    //timer1 Output Compare A Match Interrupt Enable
+    setbit(TIMSK, OCIE1A);
+    timer_program();
+    //Let's get the timer running (clk/1024), timer_now() counts from here on
+    TCCR1B |= TIMER_CLOCK;
+}
+
+int8_t register_timer(void (*fptr)(void), uint32_t ival, uint8_t flags)
+/*Register a function which is to be called every $ival cpu cycles. The
+ *interval is rounded to the nearest multiple of TIMER_TICK.
+ *Functions are called from the timer interrupt, unless TIMER_DEFERRED is
+ *given in $flags. In that case the interrupt only marks them as pending and
+ *timer_dispatch() calls them. Use this for everything that takes longer than
+ *a few dozen cycles or waits for something.
+ *With TIMER_ONESHOT, the function is only called once, $ival cycles from now.
+ *
+ *Return values:
+ *  0-127   id of sucessfully configured new timer. Needed to deregister later.
+ *  -1      all TIMER_MAX timers are in use.
+ *  -2      Requested interval is shorter than half a TIMER_TICK or longer
+ *          than TIMER_IDLE_TICKS.
+ */
+{
+    uint8_t id;
+    uint32_t ival_ticks = (ival + TIMER_TICK/2) / TIMER_TICK;
+
+    if(ival_ticks == 0 || ival_ticks > TIMER_IDLE_TICKS)
+    {
+        return -2;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        for(id = 0; id < TIMER_MAX; id++)
+        {
+            if(timers[id].interval == 0)
+            {
+                break;
+            }
+        }
+        if(id == TIMER_MAX)
+        {
+            return -1;
+        }
+        //else
+
+        timers[id].funcptr = fptr;
+        timers[id].interval = ival_ticks;
+        timers[id].flags = flags;
+        timers[id].expires = hw_ticks() + ival_ticks;
+        wheel_insert(id);
+        timer_reprogram();
+    }
+
+    return id;
+}
+
+void deregister_timer(int8_t id)
+{
+    if(id < 0 || id >= TIMER_MAX || timers[id].interval == 0)
+    {
+        return;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if(!(timers[id].flags & TIMER_EXPIRED))
+        {
+            wheel_remove(id);
+        }
+        timers[id].interval = 0;
+        pending &= ~((uint16_t)1<<id);
+        //the next deadline might be later now
+        timer_reprogram();
+    }
+}
+
+static void timer_advance(uint32_t now)
+/*Process all ticks up to $now. Only the slots of these ticks are looked at,
+ *every one at most once, no matter how many ticks passed. Some of the timers
+ *in them might be due a full wheel turn (or more) later, those stay where
+ *they are. The due ones are taken out of their slot first and put back (into
+ *the slot of their next expiry) before their functions get called, so these
+ *may (de)register timers themselves. A periodic timer that is late by more
+ *than its interval is only called once, it skips the periods it missed.
+ */
+{
+    uint8_t* link;
+    uint8_t id;
+    uint8_t i;
+    uint8_t n;
+    uint32_t from = ticks;
+    uint32_t late;
+    uint8_t due = TIMER_NONE;   //list of timers to call
+
+    if(now == ticks)
+    {
+        return;
+    }
+    n = now - from < TIMER_WHEEL_SLOTS ? now - from : TIMER_WHEEL_SLOTS;
+    for(i = 1; i <= n; i++)
+    {
+        link = &wheel[(uint8_t)(from + i) & (TIMER_WHEEL_SLOTS-1)];
+        while(*link != TIMER_NONE)
+        {
+            id = *link;
+            //expires in from+1 ... now
+            if(timers[id].expires - from - 1 < now - from)
+            {
+                *link = timers[id].next;
+                timers[id].next = due;
+                due = id;
+            }
+            else
+            {
+                link = &timers[id].next;
+            }
+        }
+    }
+    ticks = now;
+
+    while(due != TIMER_NONE)
+    {
+        id = due;
+        due = timers[id].next;
+        if(timers[id].interval == 0)
+        {
+            //deregistered by one of the functions called before
+            continue;
+        }
+        if(timers[id].flags & TIMER_ONESHOT)
+        {
+            //not put back, freed after its function was called
+            timers[id].flags |= TIMER_EXPIRED;
+        }
+        else
+        {
+            late = now - timers[id].expires;
+            timers[id].expires += timers[id].interval;
+            if(late >= timers[id].interval)
+            {
+                timers[id].expires += late / timers[id].interval
+                                      * timers[id].interval;
+            }
+            wheel_insert(id);
+        }
+        if(timers[id].flags & TIMER_DEFERRED)
+        {
+            pending |= (uint16_t)1<<id;
+            event_post(EV_TIMER);
+        }
+        else
+        {
+            timers[id].funcptr();
+            if(timers[id].flags & TIMER_EXPIRED)
+            {
+                timers[id].interval = 0;
+            }
+        }
+    }
+#if TIMER_TICKLESS
+    timer_next();
+#endif
+}
+
+ISR(TIMER1_COMPA_vect)
+/*Process all ticks up to now. If the called functions took longer than the
+ *time to the next deadline, we catch up before returning.
+ */
+{
+    do
+    {
+        timer_advance(hw_ticks());
+    } while(timer_program());
+}
+
+void timer_dispatch(void)
+/*Call the functions of all deferred timers that expired since the last call.
+ *Meant to be called from the main loop on EV_TIMER. If a timer expired
+ *several times in between, its function is called only once.
+ */
+{
+    uint16_t run;
+    uint8_t id;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        run = pending;
+        pending = 0;
+    }
+
+    for(id = 0; run != 0; id++, run >>= 1)
+    {
+        //the interval check catches timers deregistered in the meantime
+        if((run & 0x01) && timers[id].interval != 0)
+        {
+            timers[id].funcptr();
+            if(timers[id].flags & TIMER_EXPIRED)
+            {
+                ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+                {
+                    timers[id].interval = 0;
+                }
+            }
+        }
+    }
+}
+
+uint32_t timer_now(void)
+/*Monotonic uptime in ticks (TIMER_TICK cpu cycles) since timer_init(), not
+ *counting standby. Wraps around after 50 days, so only compare differences
+ *of two values.
+ *Safe to call from interrupt context as well.
+ */
+{
+    uint32_t now;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        now = hw_ticks();
+    }
+    return now + uptime_base;
+}
+
+void timer_continue(uint32_t uptime)
+/*Make timer_now() go on from $uptime, after a warm restart. Call right
+ *after timer_init(), before anyone took note of timer_now().
+ */
+{
+    uptime_base = uptime - timer_now();
+}
+
+void timer_hold(void)
+/*Keep the timer interrupt from running, for time critical sections that
+ *can't have interrupts disabled completely. Timers that become due in the
+ *meantime are called late, after timer_release(). Keep it short anyway,
+ *the display multiplexing stops meanwhile.
+ */
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        clearbit(TIMSK, OCIE1A);
+    }
+}
+
+void timer_release(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        setbit(TIMSK, OCIE1A);
+    }
+}
+
+void timer_suspend(void)
+/*Stop the clock of timer1, for standby. The counter and with it timer_now()
+ *stand still until timer_resume(), no timer is called in between and all of
+ *them are just as far from expiring afterwards.
+ */
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        TCCR1B &= ~TIMER_CLOCK;
+    }
+}
+
+void timer_resume(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        TCCR1B |= TIMER_CLOCK;
+    }
+}
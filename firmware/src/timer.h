@@ -1,17 +1,56 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+//cpu cycles per timer tick. Timer1 runs from the /1024 prescaler, so every
+//counter step is exactly one tick.
+#define TIMER_TICK          1024UL
+//convert milliseconds to the cpu cycles register_timer() expects
+#define TIMER_MS(ms)        ((ms)*(F_CPU/1000UL))
+//convert milliseconds to ticks, e.g. for comparing with timer_now()
+#define TIMER_TICKS(ms)     ((ms)*(F_CPU/1000UL)/TIMER_TICK)
+//maximum number of timers registered at the same time
+#define TIMER_MAX           12
+//number of slots in the timer wheel, has to be a power of two
+#define TIMER_WHEEL_SLOTS   16
+//Only wake up for ticks at which a timer is due instead of every tick. This
+//saves nothing while a timer runs every tick, like disp_cycle() does as long
+//as io_init() registered it.
+#ifndef TIMER_TICKLESS
+#define TIMER_TICKLESS      1
+#endif
+//longest interval. In tickless mode the interrupt comes every
+//TIMER_IDLE_TICKS at least, so the 16 bit counter can be extended to the
+//tick count.
+#define TIMER_IDLE_TICKS    0x4000
+#if TIMER_MAX > 16
+#error "deferred timers are tracked in 16 bits, TIMER_MAX must be <= 16"
+#endif
+//marks the end of a slot list / an empty slot
+#define TIMER_NONE          0xFF
+
+//register_timer() options
+//Don't call the function from the interrupt, but from timer_dispatch()
+#define TIMER_DEFERRED      0x01
+//Call the function only once, the timer is deregistered afterwards
+#define TIMER_ONESHOT       0x02
+
 typedef struct Timer{
     void (*funcptr)(void);
-    uint32_t interval;
-    uint32_t downscaled;
-    uint32_t countdown;
-    int8_t id;	//for identifying timer at removal
-    struct Timer* next; //we'll have a linked list
+    uint32_t interval;  //in ticks, 0 if this entry is unused
+    uint32_t expires;   //tick at which funcptr is due next
+    uint8_t next;       //id of next timer in the same wheel slot
+    uint8_t flags;      //TIMER_* options given on registration
 } timer;
 
 void timer_init(void);
-int8_t register_timer(void (*fptr)(void), uint32_t ival);
+int8_t register_timer(void (*fptr)(void), uint32_t ival, uint8_t flags);
 void deregister_timer(int8_t id);
+void timer_dispatch(void);
+uint32_t timer_now(void);
+void timer_continue(uint32_t uptime);
+void timer_hold(void);
+void timer_release(void);
+void timer_suspend(void);
+void timer_resume(void);
 
 #endif
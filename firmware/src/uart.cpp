@@ -0,0 +1,127 @@
+#include "common.h" 
+#include "uart.h"
+#include "event.h"
+#include "timer.h"
+
+//a byte received this many ticks after a dropped one is part of the same
+//input, at 9600 baud a byte takes a tick
+#define RX_RESUME_TICKS 2
+
+/*Ring buffers. The writing side owns the head, the reading side the tail, so
+ *each index is only ever changed from one context. Empty if head == tail.
+ */
+static uint8_t tx_buf[UART_TX_SIZE];
+static volatile uint8_t tx_head;
+static volatile uint8_t tx_tail;
+
+static uint8_t rx_buf[UART_RX_SIZE];
+static volatile uint8_t rx_head;
+static volatile uint8_t rx_tail;
+static uint8_t rx_dropping;         //the last byte received was dropped
+static uint32_t rx_dropped_at;      //timer_now() of the last dropped byte
+
+volatile uint8_t uart_rx_overflows;
+volatile uint8_t uart_rx_resumed;
+uint8_t uart_tx_overflows;
+
+ISR(USART_UDRE_vect)
+/*Data register empty, send next byte or stop if there is none
+ */
+{
+    if(tx_head == tx_tail)
+    {
+        clearbit(UCSRB, UDRIE);
+        return;
+    }
+    UDR = tx_buf[tx_tail];
+    tx_tail = (tx_tail + 1) & (UART_TX_SIZE-1);
+}
+
+ISR(USART_RXC_vect)
+{
+    uint8_t c = UDR;
+    uint8_t next = (rx_head + 1) & (UART_RX_SIZE-1);
+
+    if(next == rx_tail)
+    {
+        //buffer full, drop the new byte
+        if(!rx_dropping)
+        {
+            uart_rx_overflows++;
+            rx_dropping = 1;
+        }
+        rx_dropped_at = timer_now();
+    }
+    else
+    {
+        if(rx_dropping && timer_now() - rx_dropped_at <= RX_RESUME_TICKS)
+        {
+            uart_rx_resumed++;
+        }
+        rx_buf[rx_head] = c;
+        rx_head = next;
+        rx_dropping = 0;
+    }
+    event_post(EV_UART);
+}
+
+int8_t uart_trywrite(char c)
+/*Put a byte into the TX buffer. Returns -1 if it's full.
+ *Not for interrupt context, there's only one writer to the buffer.
+ */
+{
+    uint8_t next = (tx_head + 1) & (UART_TX_SIZE-1);
+
+    if(next == tx_tail)
+    {
+        if(uart_tx_overflows != 0xFF)
+        {
+            uart_tx_overflows++;
+        }
+        return -1;
+    }
+    tx_buf[tx_head] = c;
+    tx_head = next;
+    //(re)start sending, the interrupt routine stops when it's done
+    setbit(UCSRB, UDRIE);
+    return 0;
+}
+
+uint8_t uart_txfree(void)
+/*Number of bytes that fit into the TX buffer right now
+ */
+{
+    return (tx_tail - tx_head - 1) & (UART_TX_SIZE-1);
+}
+
+int16_t uart_tryread(void)
+/*Get a received byte, -1 if there is none.
+ */
+{
+    uint8_t c;
+
+    if(rx_head == rx_tail)
+    {
+        return -1;
+    }
+    c = rx_buf[rx_tail];
+    rx_tail = (rx_tail + 1) & (UART_RX_SIZE-1);
+    return c;
+}
+
+void uart_init(void)
+{
+    //also pretty much what the glibc pages tell you to do
+    UBRRH = UBRRH_VALUE;
+    UBRRL = UBRRL_VALUE;
+    #if USE_2X
+        UCSRA |= (1 << U2X);
+    #else
+        UCSRA &= ~(1 << U2X);
+    #endif
+
+    UCSRB |= (1<<TXEN);     //enable UART TX
+    UCSRC = (1<<URSEL)|(1<<UCSZ1)|(1<<UCSZ0);   // asynchronous 8N1
+    UCSRB |= (1<<RXEN);     //enable UART RX
+    UCSRB |= (1<<RXCIE);    //RX complete interrupt, wakes up the main loop
+}
@@ -4,6 +4,31 @@
 #define BAUD 9600UL
 #include <util/setbaud.h>
 
+//buffer sizes, have to be powers of two (one byte of each stays unused)
+#define UART_TX_SIZE    64
+#define UART_RX_SIZE    16
+
+/*What fmt_char() does when the TX buffer is full: with UART_TX_DROP the byte
+ *is dropped (and counted in uart_tx_overflows), so logging can never stall
+ *the control loop. Otherwise wait for space, which needs interrupts enabled.
+ *Received bytes are always dropped when the RX buffer is full.
+ */
+#ifndef UART_TX_DROP
+#define UART_TX_DROP    1
+#endif
+
+//times received bytes were dropped, a run of them counts once. Wraps
+//around, so only compare it with an earlier value.
+extern volatile uint8_t uart_rx_overflows;
+//runs of dropped bytes that more input followed right away, so they left a
+//gap within the input instead of cutting off its end. Wraps around as well.
+extern volatile uint8_t uart_rx_resumed;
+//number of dropped bytes to send, saturating at 255
+extern uint8_t uart_tx_overflows;
+
 void uart_init(void);
+int8_t uart_trywrite(char c);
+uint8_t uart_txfree(void);
+int16_t uart_tryread(void);
 
 #endif
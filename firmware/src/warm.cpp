@@ -0,0 +1,47 @@
+#include "common.h"
+#include <stddef.h>
+#include <util/crc16.h>
+#include "warm.h"
+
+static warm_block block __attribute__((section(".noinit")));
+
+static uint16_t block_crc(void)
+{
+    const uint8_t* p = (const uint8_t*)&block;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for(i = 0; i < offsetof(warm_block, crc); i++)
+    {
+        crc = _crc_ccitt_update(crc, p[i]);
+    }
+    return crc;
+}
+
+uint8_t warm_load(warm_state* s)
+/*Call once, before anything else after the reset. Returns 1 and fills $s
+ *with what warm_save() saved last if this is a warm restart, 0 otherwise.
+ *Clears the reset flags, so the next reset is told apart correctly.
+ */
+{
+    uint8_t cause = MCUCSR;
+
+    MCUCSR = 0;
+    if((cause & ((1<<PORF) | (1<<BORF))) || block.magic != WARM_MAGIC
+       || block.crc != block_crc())
+    {
+        return 0;
+    }
+    *s = block.s;
+    return 1;
+}
+
+void warm_save(const warm_state* s)
+/*A reset while this runs leaves a block with a wrong crc, which is simply
+ *not used.
+ */
+{
+    block.magic = WARM_MAGIC;
+    block.s = *s;
+    block.crc = block_crc();
+}
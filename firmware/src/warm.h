@@ -0,0 +1,31 @@
+#ifndef WARM_H
+#define WARM_H
+
+/*State of the controller kept in RAM across resets that don't lose its
+ *contents (watchdog, reset pin), so it can carry on where it was instead of
+ *starting from defaults and waiting for the first sensor reading. The block
+ *is in .noinit, which the startup code leaves alone. It's only trusted if
+ *MCUCSR says it wasn't a power-on or brown-out reset, and the magic number
+ *and the crc match.
+ */
+
+#define WARM_MAGIC      0xD4A6
+
+typedef struct WarmState{
+    uint32_t uptime;        //timer_now()
+    int16_t hum;            //tenths of a percent
+    int16_t ambient_temp;   //tenths of a degree celsius
+    uint8_t state;          //enum statev
+    uint8_t ref_hum;
+} warm_state;
+
+typedef struct WarmBlock{
+    uint16_t magic;
+    warm_state s;
+    uint16_t crc;           //crc-ccitt of all other bytes
+} warm_block;
+
+uint8_t warm_load(warm_state* s);
+void warm_save(const warm_state* s);
+
+#endif
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Compare the results of 'make bench' with the budgets in bench/budget.
+
+Reads the output of bench/simbench.c (cpu cycles per routine) and of
+avr-size in berkeley format (flash and RAM per module), prints them next
+to their budgets and fails if any budget is exceeded. Routines and modules
+without a budget are only printed.
+
+A budget file with an 'unmeasured' line holds placeholders, the check
+fails until they're replaced. With --update (make bench-budget) every
+budget is set to its result plus HEADROOM, and the 'unmeasured' line and
+the comment right above it are removed.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEADROOM = 10  # %
+
+
+def read_budget(name):
+    """Returns {(kind, name): limit} from lines like 'cycles disp_cycle 600',
+    and whether the file has the 'unmeasured' line"""
+    budget = {}
+    unmeasured = False
+    with open(name) as f:
+        for line in f:
+            line = line.split("#")[0].split()
+            if not line:
+                continue
+            if line == ["unmeasured"]:
+                unmeasured = True
+                continue
+            kind, what, limit = line
+            budget[(kind, what)] = int(limit)
+    return budget, unmeasured
+
+
+def with_headroom(value):
+    """value plus HEADROOM, rounded up to tens"""
+    return -(-value * (100 + HEADROOM) // 1000) * 10
+
+
+def update_budget(name, results):
+    """Sets the budgets in file $name to the results plus headroom, keeping
+    the comments. Budgets without a result are left alone."""
+    measured = {(kind, what): value for kind, what, value, _ in results}
+    lines = []
+    with open(name) as f:
+        for line in f:
+            fields = line.split("#")[0].split()
+            if fields == ["unmeasured"]:
+                while lines and lines[-1].startswith("#"):
+                    lines.pop()
+                continue
+            if len(fields) == 3 and tuple(fields[:2]) in measured:
+                limit = with_headroom(measured[tuple(fields[:2])])
+                line = re.sub(r"\d+(?=\s*(#.*)?$)", str(limit), line, 1)
+            lines.append(line)
+    with open(name, "w") as f:
+        f.writelines(lines)
+
+
+def read_results(name):
+    """Returns [(kind, name, value, detail)] from simbench and avr-size"""
+    results = []
+    with open(name) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 5 and fields[0] == "cycles":
+                _, routine, calls, avg, worst = fields
+                results.append(("cycles", routine, int(worst),
+                                "%s calls, average %s" % (calls, avg)))
+            elif len(fields) == 6 and fields[0].isdigit():
+                text, data, bss = (int(x) for x in fields[:3])
+                module = os.path.basename(fields[5])
+                results.append(("flash", module, text + data, ""))
+                results.append(("ram", module, data + bss, ""))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("budget", help="budget file")
+    parser.add_argument("results", help="output of simbench and avr-size")
+    parser.add_argument("--update", action="store_true",
+                        help="set the budgets to the results plus headroom")
+    args = parser.parse_args()
+
+    results = read_results(args.results)
+    if args.update:
+        update_budget(args.budget, results)
+    budget, unmeasured = read_budget(args.budget)
+    seen = set()
+    failed = 0
+
+    for kind, what, value, detail in results:
+        seen.add((kind, what))
+        limit = budget.get((kind, what))
+        if limit is None:
+            status = ""
+        elif value > limit:
+            status = "OVER BUDGET (%d)" % limit
+            failed += 1
+        else:
+            status = "ok (%d)" % limit
+        print("%-6s %-18s %6d  %-18s %s" % (kind, what, value, status,
+                                            detail))
+
+    for kind, what in sorted(set(budget) - seen):
+        print("%-6s %-18s not measured" % (kind, what))
+        failed += 1
+
+    if failed:
+        print("%d budgets exceeded or not measured" % failed,
+              file=sys.stderr)
+        return 1
+    if unmeasured:
+        print("the budgets are placeholders, 'make bench-budget' replaces "
+              "them with these results", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Decode the binary telemetry frames sent by the firmware (see
+src/telemetry.h) into CSV.
+
+Reads a captured serial byte stream from a file (or stdin), e.g. recorded
+with
+    stty -F /dev/ttyUSB0 9600 raw && cat /dev/ttyUSB0 > capture.bin
+and writes one CSV line per valid frame to stdout. Damaged frames are
+skipped and counted on stderr. Replies of the command shell (src/shell.h)
+on the same line are copied to stderr.
+"""
+
+import argparse
+import struct
+import sys
+
+TELEMETRY_VERSION = 1
+# must match F_CPU and TIMER_TICK of the firmware
+F_CPU = 1000000
+TIMER_TICK = 1024
+
+PAYLOAD = struct.Struct("<BBIhhhBBBH")
+STATES = {0: "off", 1: "ok", 2: "waterfull"}
+OUT_FAN = 0x01
+OUT_COMP = 0x02
+
+COLUMNS = ["uptime_s", "seq", "hum", "ambient_temp", "coil_temp",
+           "fan", "comp", "state", "ref_hum"]
+
+
+def crc_ccitt_update(crc, data):
+    """Same as _crc_ccitt_update() of avr-libc"""
+    data ^= crc & 0xFF
+    data = (data ^ (data << 4)) & 0xFF
+    return ((data << 8 | crc >> 8) ^ (data >> 4) ^ (data << 3)) & 0xFFFF
+
+
+def cobs_decode(block):
+    """Returns the decoded bytes or None if the block isn't valid COBS"""
+    out = bytearray()
+    i = 0
+    while i < len(block):
+        code = block[i]
+        if code == 0 or i + code > len(block):
+            return None
+        out += block[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(block):
+            out.append(0)
+    return bytes(out)
+
+
+def frames(stream):
+    """Yield the 0x00 delimited blocks of a byte stream. The first one might
+    be the tail of a frame, it just fails to decode then. An unterminated
+    block at the end of the stream is skipped."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        for b in chunk:
+            if b == 0:
+                if buf:
+                    yield bytes(buf)
+                buf.clear()
+            else:
+                buf.append(b)
+
+
+def shell_reply(block):
+    """Returns the text if the block is a reply line of the shell"""
+    if not block.endswith(b"\r\n"):
+        return None
+    try:
+        text = block.decode("ascii").rstrip()
+    except UnicodeDecodeError:
+        return None
+    return text if text.isprintable() else None
+
+
+def decode(block):
+    """Returns the payload fields of a frame or None if it's damaged"""
+    payload = cobs_decode(block)
+    if payload is None or len(payload) != PAYLOAD.size:
+        return None
+    crc = 0xFFFF
+    for b in payload[:-2]:
+        crc = crc_ccitt_update(crc, b)
+    fields = PAYLOAD.unpack(payload)
+    if fields[-1] != crc or fields[0] != TELEMETRY_VERSION:
+        return None
+    return fields
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", default="-",
+                        help="captured byte stream, - for stdin (default)")
+    args = parser.parse_args()
+
+    if args.capture == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.capture, "rb")
+
+    good = bad = 0
+    print(",".join(COLUMNS))
+    for block in frames(stream):
+        fields = decode(block)
+        if fields is None:
+            reply = shell_reply(block)
+            if reply is not None:
+                print("shell: " + reply, file=sys.stderr)
+            else:
+                bad += 1
+            continue
+        good += 1
+        (_, seq, ticks, hum, ambient, coil, outputs, state, ref_hum,
+         _) = fields
+        print("%.3f,%d,%.1f,%.1f,%.1f,%d,%d,%s,%d" % (
+            ticks * TIMER_TICK / F_CPU, seq, hum / 10, ambient / 10,
+            coil / 10, bool(outputs & OUT_FAN), bool(outputs & OUT_COMP),
+            STATES.get(state, state), ref_hum))
+
+    print("%d frames, %d damaged" % (good, bad), file=sys.stderr)
+    return 0 if good or not bad else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Check testdata/bench.txt against budgets written for the test.
+
+bench.txt is written by hand in the format of simbench and avr-size, it
+isn't a measurement.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+RESULTS = os.path.join(HERE, "testdata", "bench.txt")
+sys.path.insert(0, HERE)
+
+import bench_check  # noqa: E402
+
+BUDGET = """#header
+cycles TIMER1_COMPA_vect    1300
+cycles disp_cycle           400
+
+#placeholders
+unmeasured
+
+flash main.elf      7680    #whole firmware
+ram main.elf        768
+flash io.o          1750
+ram io.o            100
+"""
+
+
+class TestBudget(unittest.TestCase):
+
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.budget = os.path.join(self.dir, "budget")
+        with open(self.budget, "w") as f:
+            f.write(BUDGET.replace("unmeasured\n", ""))
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def check(self, *args):
+        return subprocess.run(
+            [sys.executable, os.path.join(HERE, "bench_check.py")]
+            + list(args) + [self.budget, RESULTS],
+            capture_output=True, text=True)
+
+    def test_results(self):
+        results = bench_check.read_results(RESULTS)
+        self.assertEqual(results[0], ("cycles", "TIMER1_COMPA_vect", 1100,
+                                      "1000 calls, average 210"))
+        self.assertIn(("flash", "main.elf", 6040, ""), results)
+        self.assertIn(("ram", "io.o", 62, ""), results)
+
+    def test_over_budget(self):
+        result = self.check()
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("OVER BUDGET (400)", result.stdout)
+        self.assertIn("1 budgets exceeded", result.stderr)
+
+    def test_unmeasured(self):
+        with open(self.budget, "w") as f:
+            f.write(BUDGET.replace("400", "500"))
+        result = self.check()
+        self.assertEqual(result.returncode, 1)
+        self.assertIn("placeholders", result.stderr)
+
+    def test_update(self):
+        with open(self.budget, "w") as f:
+            f.write(BUDGET)
+        result = self.check("--update")
+        self.assertEqual(result.returncode, 0, result.stderr)
+        with open(self.budget) as f:
+            budget = f.read()
+        self.assertNotIn("unmeasured", budget)
+        self.assertNotIn("#placeholders", budget)
+        self.assertIn("cycles disp_cycle           470\n", budget)
+        self.assertIn("flash main.elf      6650    #whole firmware\n",
+                      budget)
+        self.assertEqual(bench_check.with_headroom(100), 110)
+        self.assertEqual(bench_check.with_headroom(0), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
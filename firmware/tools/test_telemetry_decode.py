@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Decode testdata/telemetry.bin, recorded from the host simulation.
+
+The capture holds nine frames. Several have a 0xFF byte in their payload
+(humidity 51.1 %, 0x01FF), and the one with sequence number 227 has a
+flipped bit in its humidity, so its crc doesn't match.
+"""
+
+import os
+import subprocess
+import sys
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CAPTURE = os.path.join(HERE, "testdata", "telemetry.bin")
+sys.path.insert(0, HERE)
+
+import telemetry_decode  # noqa: E402
+
+
+class TestCapture(unittest.TestCase):
+
+    def decode_all(self):
+        with open(CAPTURE, "rb") as f:
+            return [telemetry_decode.decode(b)
+                    for b in telemetry_decode.frames(f)]
+
+    def test_frames(self):
+        fields = self.decode_all()
+        self.assertEqual(len(fields), 9)
+        self.assertIsNone(fields[1])
+        good = [f for f in fields if f is not None]
+        self.assertEqual([f[1] for f in good],
+                         [226, 228, 229, 230, 231, 232, 233, 234])
+        self.assertEqual([f[3] for f in good],
+                         [512, 511, 511, 511, 511, 511, 510, 510])
+
+    def test_values(self):
+        (version, seq, ticks, hum, ambient, coil, outputs, state, ref_hum,
+         _) = self.decode_all()[2]
+        self.assertEqual(version, telemetry_decode.TELEMETRY_VERSION)
+        self.assertEqual(seq, 228)
+        self.assertEqual(ticks, 1447173)
+        self.assertEqual(hum, 511)
+        self.assertEqual(ambient, 226)
+        self.assertEqual(coil, 117)
+        self.assertEqual(outputs, telemetry_decode.OUT_FAN
+                         | telemetry_decode.OUT_COMP)
+        self.assertEqual(telemetry_decode.STATES[state], "ok")
+        self.assertEqual(ref_hum, 50)
+
+    def test_csv(self):
+        result = subprocess.run(
+            [sys.executable, os.path.join(HERE, "telemetry_decode.py"),
+             CAPTURE], capture_output=True, text=True)
+        self.assertEqual(result.returncode, 0)
+        lines = result.stdout.splitlines()
+        self.assertEqual(lines[0], ",".join(telemetry_decode.COLUMNS))
+        self.assertEqual(len(lines), 1 + 8)
+        self.assertEqual(lines[2], "1481.905,228,51.1,22.6,11.7,1,1,ok,50")
+        self.assertEqual(result.stderr.strip(), "8 frames, 1 damaged")
+
+
+if __name__ == "__main__":
+    unittest.main()